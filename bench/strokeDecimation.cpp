@@ -0,0 +1,74 @@
+#include "strokeDecimation.hpp"
+#include <cmath>
+#include <utility>
+
+// Outline displacement of point i when it is replaced by the chord a -> b
+static double deviation(const StrokePoints& points, double width, size_t a, size_t b, size_t i) {
+    Point pa = points[a], pb = points[b], p = points[i];
+    double dx = pb.x - pa.x;
+    double dy = pb.y - pa.y;
+    double len2 = dx * dx + dy * dy;
+
+    // Closest point on the chord, and where along it we are
+    double t = 0.0;
+    if (len2 > 1e-12) {
+        t = ((p.x - pa.x) * dx + (p.y - pa.y) * dy) / len2;
+        t = t < 0.0 ? 0.0 : (t > 1.0 ? 1.0 : t);
+    }
+    double cx = pa.x + t * dx - p.x;
+    double cy = pa.y + t * dy - p.y;
+
+    // Half-width the outline would get there by linear interpolation
+    double wa = points.width_scale(a), wb = points.width_scale(b);
+    double half_width_change = fabs(wa + (wb - wa) * t - points.width_scale(i)) * width / 2.0;
+
+    return sqrt(cx * cx + cy * cy) + half_width_change;
+}
+
+DecimationResult decimate_stroke(const StrokePoints& points, double width, double tolerance) {
+    DecimationResult result;
+    size_t n = points.size();
+    if (n <= 2 || tolerance <= 0.0) {
+        for (size_t i = 0; i < n; i++) result.points.push_back(points[i], points.width_scale(i));
+        return result;
+    }
+
+    std::vector<bool> keep(n, false);
+    keep[0] = keep[n - 1] = true;
+
+    // Iterative subdivision; ranges are (first, last) with both ends kept
+    std::vector<std::pair<size_t, size_t>> ranges;
+    ranges.emplace_back(0, n - 1);
+    while (!ranges.empty()) {
+        auto range = ranges.back();
+        ranges.pop_back();
+        if (range.second <= range.first + 1) continue;
+
+        size_t worst = range.first;
+        double worst_deviation = -1.0;
+        for (size_t i = range.first + 1; i < range.second; i++) {
+            double d = deviation(points, width, range.first, range.second, i);
+            if (d > worst_deviation) {
+                worst_deviation = d;
+                worst = i;
+            }
+        }
+
+        if (worst_deviation > tolerance) {
+            keep[worst] = true;
+            ranges.emplace_back(range.first, worst);
+            ranges.emplace_back(worst, range.second);
+        } else if (worst_deviation > result.max_deviation) {
+            // Everything in this range is dropped; record how far it moves
+            result.max_deviation = worst_deviation;
+        }
+    }
+
+    size_t kept = 0;
+    for (bool k : keep) kept += k;
+    result.points.reserve(kept);
+    for (size_t i = 0; i < n; i++) {
+        if (keep[i]) result.points.push_back(points[i], points.width_scale(i));
+    }
+    return result;
+}
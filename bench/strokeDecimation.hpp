@@ -0,0 +1,18 @@
+#pragma once
+
+#include "../src/strokePoints.hpp"
+
+// Default decimation tolerance, in device pixels
+constexpr double DEFAULT_DECIMATION_TOLERANCE = 0.35;
+
+struct DecimationResult {
+    StrokePoints points;
+    double max_deviation = 0.0;  // Largest outline displacement caused by dropping points
+};
+
+// Ramer-Douglas-Peucker decimation of a stroke centerline. A point is dropped
+// only if the outline edge moves by at most `tolerance`: its distance to the
+// kept chord plus the change in half-width (width * width_scale / 2).
+// Pen-up no longer decimates (strokes are stored as fitted Beziers); the bench
+// keeps it as the baseline the fitted curves are measured against.
+DecimationResult decimate_stroke(const StrokePoints& points, double width, double tolerance);
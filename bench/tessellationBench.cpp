@@ -0,0 +1,237 @@
+// Compares fixed 12-step Catmull-Rom tessellation against the adaptive,
+// flatness-driven tessellation used by StrokeSmoother.
+//
+// Usage: tessellation_bench [recording.txt]
+//
+// A recording holds one "x y" sample per line, with blank lines between
+// strokes. Without a recording, a synthetic cursive page is generated
+// (pen samples at ~125 Hz with sub-pixel jitter).
+#include "../src/strokeSmoother.hpp"
+#include "strokeDecimation.hpp"
+#include "../src/bezierFit.hpp"
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using Samples = std::vector<std::pair<double, double>>;
+
+static std::vector<Samples> load_recording(const char* path) {
+    std::vector<Samples> strokes(1);
+    std::ifstream in(path);
+    std::string line;
+    while (std::getline(in, line)) {
+        std::istringstream ls(line);
+        double x, y;
+        if (ls >> x >> y) {
+            strokes.back().emplace_back(x, y);
+        } else if (!strokes.back().empty()) {
+            strokes.emplace_back();
+        }
+    }
+    if (strokes.back().empty()) strokes.pop_back();
+    return strokes;
+}
+
+static std::vector<Samples> synthetic_page() {
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> jitter(-0.3, 0.3);
+    std::uniform_real_distribution<double> shape(0.6, 1.4);
+    std::vector<Samples> strokes;
+
+    // 30 lines of handwriting, ~12 words per line, one stroke per word
+    for (int line = 0; line < 30; line++) {
+        double base_y = 60.0 + line * 32.0;
+        double x = 40.0;
+        for (int word = 0; word < 12; word++) {
+            Samples s;
+            double letters = 3 + (int)(shape(rng) * 3);
+            double freq = 2.0 * M_PI / 9.0 * shape(rng);
+            int samples = (int)(letters * 14);
+            for (int i = 0; i < samples; i++) {
+                double t = (double)i;
+                double px = x + t * 0.7 + 3.0 * sin(t * freq * 0.5);
+                double py = base_y - 8.0 * fabs(sin(t * freq)) * shape(rng) * 0.5 - 4.0 * sin(t * freq * 0.5);
+                s.emplace_back(px + jitter(rng), py + jitter(rng));
+            }
+            strokes.push_back(std::move(s));
+            x += letters * 10.0 + 12.0;
+        }
+    }
+    return strokes;
+}
+
+struct Result {
+    size_t points = 0;
+    size_t bytes = 0;
+    size_t decimated_points = 0;
+    size_t decimated_bytes = 0;
+    double max_deviation = 0.0;
+    double decimate_ms = 0.0;
+    size_t fitted_points = 0;    // Bezier knots and control points
+    size_t fitted_bytes = 0;
+    double fit_error = 0.0;
+    double fit_ms = 0.0;
+    double smooth_ms = 0.0;
+    double scan_ms = 0.0;
+};
+
+static Result run(const std::vector<Samples>& strokes, double tolerance, int max_segments, int repeats) {
+    Result r;
+    std::vector<StrokePoints> smoothed(strokes.size());
+
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repeats; rep++) {
+        for (size_t i = 0; i < strokes.size(); i++) {
+            StrokeSmoother smoother(tolerance, max_segments);
+            smoothed[i].clear();
+            for (const auto& s : strokes[i]) {
+                smoother.add_sample(Point(s.first, s.second), smoothed[i]);
+            }
+        }
+    }
+    auto mid = std::chrono::steady_clock::now();
+
+    // Linear eraser-style scan: distance from a set of probes to every point
+    size_t hits = 0;
+    for (int rep = 0; rep < repeats; rep++) {
+        for (int probe = 0; probe < 64; probe++) {
+            double px = 40.0 + probe * 13.0, py = 60.0 + probe * 15.0;
+            for (const auto& stroke : smoothed) {
+                for (const auto& p : stroke) {
+                    double dx = p.x - px, dy = p.y - py;
+                    if (sqrt(dx * dx + dy * dy) <= 10.0) hits++;
+                }
+            }
+        }
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    for (auto& stroke : smoothed) {
+        stroke.shrink_to_fit();
+        r.points += stroke.size();
+        r.bytes += stroke.memory_bytes();
+    }
+
+    // Error-bounded decimation as done on stroke completion (5 px pen)
+    auto decimate_start = std::chrono::steady_clock::now();
+    for (const auto& stroke : smoothed) {
+        DecimationResult d = decimate_stroke(stroke, 5.0, DEFAULT_DECIMATION_TOLERANCE);
+        d.points.shrink_to_fit();
+        r.decimated_points += d.points.size();
+        r.decimated_bytes += d.points.memory_bytes();
+        r.max_deviation = std::max(r.max_deviation, d.max_deviation);
+    }
+    r.decimate_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - decimate_start).count();
+
+    // Bezier fit as done on stroke completion: the curve is all that is stored,
+    // compared against the decimated polyline that was stored before it
+    auto fit_start = std::chrono::steady_clock::now();
+    for (const auto& stroke : smoothed) {
+        BezierFitResult f = fit_bezier_path(stroke, 5.0, DEFAULT_FIT_TOLERANCE / 2.0);
+        f.curve.shrink_to_fit();
+        r.fitted_points += f.curve.size();
+        r.fitted_bytes += f.curve.memory_bytes();
+        r.fit_error = std::max(r.fit_error, f.max_error);
+    }
+    r.fit_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - fit_start).count();
+    r.smooth_ms = std::chrono::duration<double, std::milli>(mid - start).count() / repeats;
+    r.scan_ms = std::chrono::duration<double, std::milli>(end - mid).count() / repeats;
+    if (hits == 0) std::cerr << "(no probe hits)\n";
+    return r;
+}
+
+// Whole-page re-tessellation (import / zoom change): one scalar evaluation
+// per t versus the batched spline kernel over all segments at once
+static void bench_batch_kernel(const std::vector<Samples>& strokes, int repeats) {
+    std::vector<SplineSegment> segments;
+    std::vector<Point> controls;
+    for (const auto& stroke : strokes) {
+        if (stroke.size() < 3) continue;
+        for (size_t i = 0; i + 1 < stroke.size(); i++) {
+            auto at = [&](size_t k) { return Point(stroke[k].first, stroke[k].second); };
+            Point p0 = at(i > 0 ? i - 1 : i), p1 = at(i), p2 = at(i + 1), p3 = at(i + 2 < stroke.size() ? i + 2 : i + 1);
+            segments.push_back(make_catmull_rom_segment(p0, p1, p2, p3, 12));
+            controls.push_back(p0);
+            controls.push_back(p1);
+            controls.push_back(p2);
+            controls.push_back(p3);
+        }
+    }
+
+    std::vector<double> xs, ys;
+    double checksum = 0.0;
+    auto start = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repeats; rep++) {
+        xs.clear();
+        ys.clear();
+        for (size_t i = 0; i < segments.size(); i++) {
+            const Point* p = &controls[4 * i];
+            for (int j = 1; j <= 12; j++) {
+                double t = (double)j / 12;
+                double t2 = t * t;
+                double t3 = t2 * t;
+                xs.push_back(0.5 * ((2.0 * p[1].x) + (-p[0].x + p[2].x) * t +
+                                    (2.0 * p[0].x - 5.0 * p[1].x + 4.0 * p[2].x - p[3].x) * t2 +
+                                    (-p[0].x + 3.0 * p[1].x - 3.0 * p[2].x + p[3].x) * t3));
+                ys.push_back(0.5 * ((2.0 * p[1].y) + (-p[0].y + p[2].y) * t +
+                                    (2.0 * p[0].y - 5.0 * p[1].y + 4.0 * p[2].y - p[3].y) * t2 +
+                                    (-p[0].y + 3.0 * p[1].y - 3.0 * p[2].y + p[3].y) * t3));
+            }
+        }
+        checksum += xs.back();
+    }
+    auto mid = std::chrono::steady_clock::now();
+    for (int rep = 0; rep < repeats; rep++) {
+        evaluate_spline_segments(segments, xs, ys);
+        checksum -= xs.back();
+    }
+    auto end = std::chrono::steady_clock::now();
+
+    std::printf("\nbatch re-tessellation of %zu segments x 12 steps:\n", segments.size());
+    std::printf("  per-t scalar %.3f ms, %s kernel %.3f ms (checksum %g)\n",
+                std::chrono::duration<double, std::milli>(mid - start).count() / repeats, spline_kernel_name(),
+                std::chrono::duration<double, std::milli>(end - mid).count() / repeats, checksum);
+}
+
+int main(int argc, char** argv) {
+    std::vector<Samples> strokes = argc > 1 ? load_recording(argv[1]) : synthetic_page();
+    size_t samples = 0;
+    for (const auto& s : strokes) samples += s.size();
+    std::printf("%zu strokes, %zu samples (%s), %s spline kernel\n\n", strokes.size(), samples,
+                argc > 1 ? argv[1] : "synthetic", spline_kernel_name());
+
+    const int repeats = 20;
+    Result fixed = run(strokes, 0.0, 12, repeats);
+    std::printf("%-22s %10s %12s %12s %12s\n", "mode", "points", "KiB", "smooth ms", "scan ms");
+    auto report = [&](const char* name, const Result& r) {
+        std::printf("%-22s %10zu %12.1f %12.3f %12.3f\n", name, r.points,
+                    r.bytes / 1024.0, r.smooth_ms, r.scan_ms);
+        std::printf("  decimated to %zu points (%.1f KiB) in %.3f ms, max deviation %.3f px (bound %.2f)\n",
+                    r.decimated_points, r.decimated_bytes / 1024.0, r.decimate_ms, r.max_deviation,
+                    DEFAULT_DECIMATION_TOLERANCE);
+        std::printf("  fitted to %zu Bezier points (%.1f KiB, %.2fx the decimated polyline) in %.3f ms, max error %.3f px (bound %.2f)\n",
+                    r.fitted_points, r.fitted_bytes / 1024.0, (double)r.fitted_bytes / r.decimated_bytes,
+                    r.fit_ms, r.fit_error, DEFAULT_FIT_TOLERANCE / 2.0);
+    };
+    report("fixed 12 steps", fixed);
+
+    for (int scale = 1; scale <= 2; scale++) {
+        Result adaptive = run(strokes, DEFAULT_FLATNESS_TOLERANCE / scale, MAX_SEGMENTS_PER_CURVE, repeats);
+        char name[64];
+        std::snprintf(name, sizeof(name), "adaptive (scale %d)", scale);
+        report(name, adaptive);
+        std::printf("  saves %zu points (%.1fx fewer), %.3f ms smoothing, %.3f ms per scan\n",
+                    fixed.points - adaptive.points, (double)fixed.points / adaptive.points,
+                    fixed.smooth_ms - adaptive.smooth_ms, fixed.scan_ms - adaptive.scan_ms);
+    }
+
+    bench_batch_kernel(strokes, repeats);
+    return 0;
+}
@@ -0,0 +1,646 @@
+#include "bezierFit.hpp"
+#include "geometry.hpp"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Newton-Raphson passes tried on a missed segment before splitting it
+static const int MAX_REPARAMETERIZE = 8;
+
+// Turns sharper than ~60 degrees split the fit without a shared tangent
+static const double CORNER_COS = 0.5;
+
+// Distance, in multiples of the tolerance, over which tangents and turns are measured
+static const double TANGENT_REACH = 4.0;
+
+// Step cap for flattening one segment, and the flatness used for hit testing
+static const int MAX_FLATTEN_STEPS = 64;
+static const double HIT_TEST_FLATNESS = 0.25;
+
+// Offsetting a segment more than this many times in half is not worth it
+static const int MAX_OFFSET_DEPTH = 4;
+
+// Joins within ~2 degrees are smooth (knots are stored as floats); smaller
+// gaps than this between offset pieces are closed without a bridge
+static const double SMOOTH_JOIN_COS = 0.9994;
+static const double JOIN_SNAP = 0.01;
+
+static Point add(const Point& a, const Point& b) { return Point(a.x + b.x, a.y + b.y); }
+static Point sub(const Point& a, const Point& b) { return Point(a.x - b.x, a.y - b.y); }
+static Point mul(const Point& a, double s) { return Point(a.x * s, a.y * s); }
+static double dot(const Point& a, const Point& b) { return a.x * b.x + a.y * b.y; }
+static double length(const Point& a) { return sqrt(dot(a, a)); }
+
+// Unit vector from `from` to `to`, or zero if they coincide
+static Point direction(const Point& from, const Point& to) {
+    Point d = sub(to, from);
+    double len = length(d);
+    return len > 1e-12 ? mul(d, 1.0 / len) : Point(0.0, 0.0);
+}
+
+static Point bezier_point(const Point* b, double t) {
+    double s = 1.0 - t;
+    return Point(s * s * s * b[0].x + 3.0 * s * s * t * b[1].x + 3.0 * s * t * t * b[2].x + t * t * t * b[3].x,
+                 s * s * s * b[0].y + 3.0 * s * s * t * b[1].y + 3.0 * s * t * t * b[2].y + t * t * t * b[3].y);
+}
+
+static Point bezier_derivative(const Point* b, double t) {
+    double s = 1.0 - t;
+    return add(add(mul(sub(b[1], b[0]), 3.0 * s * s), mul(sub(b[2], b[1]), 6.0 * s * t)), mul(sub(b[3], b[2]), 3.0 * t * t));
+}
+
+static Point bezier_second_derivative(const Point* b, double t) {
+    Point a = add(sub(b[2], mul(b[1], 2.0)), b[0]);
+    Point c = add(sub(b[3], mul(b[2], 2.0)), b[1]);
+    return add(mul(a, 6.0 * (1.0 - t)), mul(c, 6.0 * t));
+}
+
+int bezier_subdivisions(const Point& b0, const Point& b1, const Point& b2, const Point& b3,
+                        double tolerance, int max_segments) {
+    if (tolerance <= 0.0) return max_segments;
+
+    // Wang's formula: the second differences of the control polygon bound
+    // how far the curve bends away from its chords
+    double d1x = b0.x - 2.0 * b1.x + b2.x;
+    double d1y = b0.y - 2.0 * b1.y + b2.y;
+    double d2x = b1.x - 2.0 * b2.x + b3.x;
+    double d2y = b1.y - 2.0 * b2.y + b3.y;
+    double bend = sqrt(std::max(d1x * d1x + d1y * d1y, d2x * d2x + d2y * d2y));
+
+    int steps = (int)ceil(sqrt(0.75 * bend / tolerance));
+    return std::min(std::max(steps, 1), max_segments);
+}
+
+// Working state for one fit: the input as doubles, duplicates removed
+struct FitInput {
+    std::vector<Point> points;
+    std::vector<double> widths;
+    double width;
+};
+
+// Chord-length parameters of points [first, last], normalized to 0..1
+static void chord_length_parameters(const FitInput& in, size_t first, size_t last, std::vector<double>& u) {
+    u.assign(last - first + 1, 0.0);
+    for (size_t i = first + 1; i <= last; i++) {
+        u[i - first] = u[i - first - 1] + length(sub(in.points[i], in.points[i - 1]));
+    }
+    double total = u.back();
+    if (total <= 0.0) return;
+    for (auto& v : u) v /= total;
+}
+
+// Least-squares control points for fixed end tangents and parameters
+static void generate_bezier(const FitInput& in, size_t first, size_t last, const std::vector<double>& u,
+                            const Point& t1, const Point& t2, Point* b) {
+    const Point& p0 = in.points[first];
+    const Point& p3 = in.points[last];
+    double c00 = 0.0, c01 = 0.0, c11 = 0.0, x0 = 0.0, x1 = 0.0;
+
+    for (size_t i = first; i <= last; i++) {
+        double t = u[i - first], s = 1.0 - t;
+        double b0 = s * s * s, b1 = 3.0 * s * s * t, b2 = 3.0 * s * t * t, b3 = t * t * t;
+        Point a1 = mul(t1, b1);
+        Point a2 = mul(t2, b2);
+        c00 += dot(a1, a1);
+        c01 += dot(a1, a2);
+        c11 += dot(a2, a2);
+        Point rest = sub(in.points[i], add(mul(p0, b0 + b1), mul(p3, b2 + b3)));
+        x0 += dot(a1, rest);
+        x1 += dot(a2, rest);
+    }
+
+    double chord = length(sub(p3, p0));
+    double det = c00 * c11 - c01 * c01;
+    double alpha1 = 0.0, alpha2 = 0.0;
+    if (fabs(det) > 1e-12) {
+        alpha1 = (x0 * c11 - x1 * c01) / det;
+        alpha2 = (c00 * x1 - c01 * x0) / det;
+    }
+
+    // Degenerate or backwards handles: fall back to the classic third of the chord
+    double epsilon = 1e-6 * chord;
+    if (alpha1 < epsilon || alpha2 < epsilon) {
+        alpha1 = alpha2 = chord / 3.0;
+    }
+
+    b[0] = p0;
+    b[1] = add(p0, mul(t1, alpha1));
+    b[2] = add(p3, mul(t2, alpha2));
+    b[3] = p3;
+}
+
+// Largest error over the inner points and the index where it occurs
+static double max_fit_error(const FitInput& in, size_t first, size_t last, const std::vector<double>& u,
+                            const Point* b, size_t& worst) {
+    double w0 = in.widths[first], w3 = in.widths[last];
+    double max_error = 0.0;
+    worst = (first + last) / 2;
+    for (size_t i = first + 1; i < last; i++) {
+        double t = u[i - first];
+        double error = length(sub(bezier_point(b, t), in.points[i]));
+        error += fabs(w0 + (w3 - w0) * t - in.widths[i]) * in.width / 2.0;
+        if (error > max_error) {
+            max_error = error;
+            worst = i;
+        }
+    }
+    return max_error;
+}
+
+// One Newton-Raphson step per point towards its closest parameter on the curve
+static void reparameterize(const FitInput& in, size_t first, size_t last, std::vector<double>& u, const Point* b) {
+    for (size_t i = first; i <= last; i++) {
+        double& t = u[i - first];
+        Point d = sub(bezier_point(b, t), in.points[i]);
+        Point d1 = bezier_derivative(b, t);
+        Point d2 = bezier_second_derivative(b, t);
+        double denominator = dot(d1, d1) + dot(d, d2);
+        if (fabs(denominator) < 1e-12) continue;
+        t = std::min(1.0, std::max(0.0, t - dot(d, d1) / denominator));
+    }
+}
+
+static void append_segment(StrokePoints& curve, const Point* b, double w0, double w3) {
+    if (curve.empty()) curve.push_back(b[0], w0);
+    curve.push_back(b[1], (2.0 * w0 + w3) / 3.0);
+    curve.push_back(b[2], (w0 + 2.0 * w3) / 3.0);
+    curve.push_back(b[3], w3);
+}
+
+// First point at least `reach` away from point i, walking by `step` but not past `limit`
+static size_t reach_index(const FitInput& in, size_t i, int step, size_t limit, double reach) {
+    size_t j = i;
+    while (j != limit) {
+        j = step > 0 ? j + 1 : j - 1;
+        if (length(sub(in.points[j], in.points[i])) >= reach) break;
+    }
+    return j;
+}
+
+// Sharp turns (cusps in handwriting) where the curve should not be forced smooth
+static std::vector<size_t> find_corners(const FitInput& in, double reach) {
+    size_t n = in.points.size();
+    std::vector<double> turn(n, 0.0);
+    for (size_t i = 1; i + 1 < n; i++) {
+        Point in_dir = direction(in.points[reach_index(in, i, -1, 0, reach)], in.points[i]);
+        Point out_dir = direction(in.points[i], in.points[reach_index(in, i, 1, n - 1, reach)]);
+        turn[i] = dot(in_dir, out_dir);  // cos of the turning angle
+    }
+
+    std::vector<size_t> corners;
+    for (size_t i = 1; i + 1 < n; i++) {
+        if (turn[i] > CORNER_COS) continue;
+        // Keep only the sharpest point of each turn
+        size_t back = reach_index(in, i, -1, 0, reach), ahead = reach_index(in, i, 1, n - 1, reach);
+        bool sharpest = true;
+        for (size_t j = back; j <= ahead && sharpest; j++) {
+            if (turn[j] < turn[i] || (turn[j] == turn[i] && j < i)) sharpest = false;
+        }
+        if (sharpest) corners.push_back(i);
+    }
+    return corners;
+}
+
+BezierFitResult fit_bezier_path(const StrokePoints& points, double width, double tolerance) {
+    BezierFitResult result;
+
+    FitInput in;
+    in.width = width;
+    in.points.reserve(points.size());
+    in.widths.reserve(points.size());
+    for (size_t i = 0; i < points.size(); i++) {
+        Point p = points[i];
+        if (!in.points.empty() && length(sub(p, in.points.back())) < 1e-9) continue;
+        in.points.push_back(p);
+        in.widths.push_back(points.width_scale(i));
+    }
+
+    size_t n = in.points.size();
+    if (n == 0) return result;
+    if (n == 1) {
+        result.curve.push_back(in.points[0], in.widths[0]);
+        return result;
+    }
+
+    // Straight cubics through every input point
+    if (tolerance <= 0.0) {
+        result.curve.reserve(3 * (n - 1) + 1);
+        for (size_t i = 0; i + 1 < n; i++) {
+            Point d = sub(in.points[i + 1], in.points[i]);
+            Point b[4] = {in.points[i], add(in.points[i], mul(d, 1.0 / 3.0)),
+                          add(in.points[i], mul(d, 2.0 / 3.0)), in.points[i + 1]};
+            append_segment(result.curve, b, in.widths[i], in.widths[i + 1]);
+        }
+        return result;
+    }
+
+    // Tangents are measured over a short reach so sub-pixel wobble doesn't steer them
+    double reach = TANGENT_REACH * tolerance;
+
+    // Fit each run between corners on its own; inside a run, splits share a tangent
+    struct FitRange {
+        size_t first, last;
+        Point t1, t2;
+    };
+    std::vector<FitRange> ranges;
+    std::vector<size_t> corners = find_corners(in, reach);
+    corners.push_back(n - 1);
+    size_t run_start = 0;
+    for (size_t corner : corners) {
+        ranges.push_back({run_start, corner,
+                          direction(in.points[run_start], in.points[reach_index(in, run_start, 1, corner, reach)]),
+                          direction(in.points[corner], in.points[reach_index(in, corner, -1, run_start, reach)])});
+        run_start = corner;
+    }
+    // Ranges are fitted left to right, so the stack holds them in reverse
+    std::reverse(ranges.begin(), ranges.end());
+
+    std::vector<double> u;
+    Point b[4] = {Point(0.0, 0.0), Point(0.0, 0.0), Point(0.0, 0.0), Point(0.0, 0.0)};
+
+    while (!ranges.empty()) {
+        FitRange range = ranges.back();
+        ranges.pop_back();
+
+        if (range.last == range.first + 1) {
+            double third = length(sub(in.points[range.last], in.points[range.first])) / 3.0;
+            b[0] = in.points[range.first];
+            b[1] = add(b[0], mul(range.t1, third));
+            b[3] = in.points[range.last];
+            b[2] = add(b[3], mul(range.t2, third));
+            append_segment(result.curve, b, in.widths[range.first], in.widths[range.last]);
+            continue;
+        }
+
+        chord_length_parameters(in, range.first, range.last, u);
+        generate_bezier(in, range.first, range.last, u, range.t1, range.t2, b);
+        size_t worst;
+        double error = max_fit_error(in, range.first, range.last, u, b, worst);
+
+        // Chord-length parameters are only a first guess; improving them
+        // often saves a split
+        for (int pass = 0; pass < MAX_REPARAMETERIZE && error > tolerance; pass++) {
+            reparameterize(in, range.first, range.last, u, b);
+            generate_bezier(in, range.first, range.last, u, range.t1, range.t2, b);
+            error = max_fit_error(in, range.first, range.last, u, b, worst);
+        }
+
+        if (error <= tolerance) {
+            append_segment(result.curve, b, in.widths[range.first], in.widths[range.last]);
+            result.max_error = std::max(result.max_error, error);
+            continue;
+        }
+
+        // Split at the worst point with a shared tangent so the join stays smooth;
+        // the right half is pushed first so the left one is fitted next
+        Point center = direction(in.points[reach_index(in, worst, 1, range.last, reach)],
+                                 in.points[reach_index(in, worst, -1, range.first, reach)]);
+        if (center.x == 0.0 && center.y == 0.0) {
+            Point normal = direction(in.points[worst], in.points[worst - 1]);
+            center = Point(-normal.y, normal.x);
+        }
+        ranges.push_back({worst, range.last, mul(center, -1.0), range.t2});
+        ranges.push_back({range.first, worst, range.t1, center});
+    }
+
+    result.curve.shrink_to_fit();
+    return result;
+}
+
+StrokePoints flatten_bezier_path(const StrokePoints& curve, double tolerance) {
+    StrokePoints out;
+    if (curve.empty()) return out;
+    out.push_back(curve[0], curve.width_scale(0));
+
+    for (size_t i = 0; i + 3 < curve.size(); i += 3) {
+        Point b[4] = {curve[i], curve[i + 1], curve[i + 2], curve[i + 3]};
+        double w0 = curve.width_scale(i), w3 = curve.width_scale(i + 3);
+        int steps = bezier_subdivisions(b[0], b[1], b[2], b[3], tolerance, MAX_FLATTEN_STEPS);
+        for (int j = 1; j <= steps; j++) {
+            double t = (double)j / steps;
+            out.push_back(bezier_point(b, t), w0 + (w3 - w0) * t);
+        }
+    }
+    return out;
+}
+
+bool bezier_path_near(const StrokePoints& curve, const Point& a, const Point& b, double radius, double width) {
+    if (curve.size() == 1) {
+        double reach = radius + width * curve.width_scale(0) / 2.0;
+        return point_segment_distance_squared(curve[0], a, b) <= reach * reach;
+    }
+
+    for (size_t i = 0; i + 3 < curve.size(); i += 3) {
+        Point c[4] = {curve[i], curve[i + 1], curve[i + 2], curve[i + 3]};
+        double w0 = curve.width_scale(i), w3 = curve.width_scale(i + 3);
+        double max_half_width = width * std::max(w0, w3) / 2.0;
+
+        // The curve lies inside its control polygon's bounding box
+        double min_x = std::min(std::min(c[0].x, c[1].x), std::min(c[2].x, c[3].x));
+        double max_x = std::max(std::max(c[0].x, c[1].x), std::max(c[2].x, c[3].x));
+        double min_y = std::min(std::min(c[0].y, c[1].y), std::min(c[2].y, c[3].y));
+        double max_y = std::max(std::max(c[0].y, c[1].y), std::max(c[2].y, c[3].y));
+        BoundingBox control_box(min_x, min_y, max_x - min_x, max_y - min_y);
+        double reach = radius + max_half_width;
+        if (segment_box_distance_squared(a, b, control_box) > reach * reach) continue;
+
+        // Width scales are linear per segment, so each flattened step is a capsule
+        int steps = bezier_subdivisions(c[0], c[1], c[2], c[3], HIT_TEST_FLATNESS, MAX_FLATTEN_STEPS);
+        Point prev = c[0];
+        double prev_scale = w0;
+        for (int j = 1; j <= steps; j++) {
+            double t = (double)j / steps;
+            Point next = bezier_point(c, t);
+            double next_scale = w0 + (w3 - w0) * t;
+            if (capsule_intersects_capsule(prev, next, width * std::max(prev_scale, next_scale) / 2.0, a, b, radius)) return true;
+            prev = next;
+            prev_scale = next_scale;
+        }
+    }
+    return false;
+}
+
+// Sample spacing along a segment when finding eraser cuts, as a fraction of the eraser radius
+static const double ERASE_SAMPLE_SPACING = 0.25;
+// Bisection steps that place a cut on the eraser boundary
+static const int ERASE_CUT_ITERATIONS = 16;
+// Pieces with a control polygon shorter than this are dropped as dust
+static const double MIN_PIECE_LENGTH = 0.5;
+
+// Part of one cubic between t0 and t1, by two de Casteljau splits
+static void append_subcurve(StrokePoints& piece, const Point* c, double t0, double t1, double w0, double w3) {
+    Point q[4] = {c[0], c[1], c[2], c[3]};
+    if (t0 > 0.0) {
+        Point p01 = add(c[0], mul(sub(c[1], c[0]), t0)), p12 = add(c[1], mul(sub(c[2], c[1]), t0));
+        Point p23 = add(c[2], mul(sub(c[3], c[2]), t0));
+        Point p012 = add(p01, mul(sub(p12, p01), t0)), p123 = add(p12, mul(sub(p23, p12), t0));
+        q[0] = add(p012, mul(sub(p123, p012), t0));
+        q[1] = p123;
+        q[2] = p23;
+    }
+    double u = t0 < 1.0 ? (t1 - t0) / (1.0 - t0) : 1.0;
+    if (u < 1.0) {
+        Point p01 = add(q[0], mul(sub(q[1], q[0]), u)), p12 = add(q[1], mul(sub(q[2], q[1]), u));
+        Point p23 = add(q[2], mul(sub(q[3], q[2]), u));
+        Point p012 = add(p01, mul(sub(p12, p01), u)), p123 = add(p12, mul(sub(p23, p12), u));
+        q[1] = p01;
+        q[2] = p012;
+        q[3] = add(p012, mul(sub(p123, p012), u));
+    }
+    append_segment(piece, q, w0 + (w3 - w0) * t0, w0 + (w3 - w0) * t1);
+}
+
+static double control_length(const StrokePoints& piece) {
+    double total = 0.0;
+    for (size_t i = 1; i < piece.size(); i++) total += length(sub(piece[i], piece[i - 1]));
+    return total;
+}
+
+bool bezier_path_erase(const StrokePoints& curve, const Point& a, const Point& b, double radius, double width,
+                       std::vector<StrokePoints>& pieces) {
+    if (curve.empty()) return false;
+    if (curve.size() == 1) {
+        // A tap either survives whole or goes whole
+        double reach = radius + width * curve.width_scale(0) / 2.0;
+        return point_segment_distance_squared(curve[0], a, b) <= reach * reach;
+    }
+
+    bool cut = false;
+    StrokePoints piece;
+    std::vector<StrokePoints> result;
+    auto close_piece = [&]() {
+        if (piece.size() >= 4 && control_length(piece) >= MIN_PIECE_LENGTH) result.push_back(std::move(piece));
+        piece = StrokePoints();
+    };
+
+    for (size_t i = 0; i + 3 < curve.size(); i += 3) {
+        Point c[4] = {curve[i], curve[i + 1], curve[i + 2], curve[i + 3]};
+        double w0 = curve.width_scale(i), w3 = curve.width_scale(i + 3);
+
+        auto inside = [&](double t) {
+            double reach = radius + width * (w0 + (w3 - w0) * t) / 2.0;
+            return point_segment_distance_squared(bezier_point(c, t), a, b) <= reach * reach;
+        };
+
+        // Out of reach of the eraser: keep the segment as it is
+        double min_x = std::min(std::min(c[0].x, c[1].x), std::min(c[2].x, c[3].x));
+        double max_x = std::max(std::max(c[0].x, c[1].x), std::max(c[2].x, c[3].x));
+        double min_y = std::min(std::min(c[0].y, c[1].y), std::min(c[2].y, c[3].y));
+        double max_y = std::max(std::max(c[0].y, c[1].y), std::max(c[2].y, c[3].y));
+        double max_reach = radius + width * std::max(w0, w3) / 2.0;
+        if (segment_box_distance_squared(a, b, BoundingBox(min_x, min_y, max_x - min_x, max_y - min_y)) > max_reach * max_reach) {
+            append_segment(piece, c, w0, w3);
+            continue;
+        }
+
+        // Sample densely enough that the eraser can't slip between two samples
+        double polygon = length(sub(c[1], c[0])) + length(sub(c[2], c[1])) + length(sub(c[3], c[2]));
+        int steps = std::max(1, (int)std::ceil(polygon / std::max(radius * ERASE_SAMPLE_SPACING, HIT_TEST_FLATNESS)));
+        steps = std::min(steps, MAX_FLATTEN_STEPS * 4);
+
+        // Walk the samples, refining each inside/outside change to a cut parameter
+        double kept_from = 0.0;
+        bool was_inside = inside(0.0);
+        for (int j = 1; j <= steps; j++) {
+            double t = (double)j / steps;
+            bool now_inside = inside(t);
+            if (now_inside == was_inside) continue;
+
+            double lo = (double)(j - 1) / steps, hi = t;
+            for (int k = 0; k < ERASE_CUT_ITERATIONS; k++) {
+                double mid = (lo + hi) / 2.0;
+                if (inside(mid) == was_inside) lo = mid;
+                else hi = mid;
+            }
+            if (was_inside) {
+                kept_from = hi;
+            } else {
+                if (lo > kept_from) append_subcurve(piece, c, kept_from, lo, w0, w3);
+                close_piece();
+            }
+            cut = true;
+            was_inside = now_inside;
+        }
+
+        if (was_inside) {
+            // The segment ends inside the eraser; a piece may already be closed
+            if (!piece.empty()) close_piece();
+            cut = true;
+        } else if (kept_from <= 0.0) {
+            append_segment(piece, c, w0, w3);
+        } else {
+            append_subcurve(piece, c, kept_from, 1.0, w0, w3);
+        }
+    }
+
+    if (!cut) return false;
+    close_piece();
+    for (auto& p : result) pieces.push_back(std::move(p));
+    return true;
+}
+
+// Appends one cubic to a chain, bridging any visible gap with a straight segment
+static void append_cubic(StrokePoints& chain, const Point* b) {
+    if (chain.empty()) {
+        chain.push_back(b[0]);
+    } else {
+        Point end = chain.back();
+        if (length(sub(b[0], end)) > JOIN_SNAP) {
+            Point d = sub(b[0], end);
+            chain.push_back(add(end, mul(d, 1.0 / 3.0)));
+            chain.push_back(add(end, mul(d, 2.0 / 3.0)));
+            chain.push_back(b[0]);
+        }
+    }
+    chain.push_back(b[1]);
+    chain.push_back(b[2]);
+    chain.push_back(b[3]);
+}
+
+// Circular arc around `center` from `start_angle`, split into quarter turns at most
+static void append_arc(StrokePoints& chain, const Point& center, double radius, double start_angle, double sweep) {
+    int pieces = std::max(1, (int)ceil(fabs(sweep) / (M_PI / 2.0) - 1e-9));
+    double step = sweep / pieces;
+    double handle = 4.0 / 3.0 * tan(step / 4.0) * radius;
+    for (int k = 0; k < pieces; k++) {
+        double a0 = start_angle + step * k, a1 = a0 + step;
+        Point b[4] = {Point(center.x + radius * cos(a0), center.y + radius * sin(a0)), Point(0.0, 0.0), Point(0.0, 0.0),
+                      Point(center.x + radius * cos(a1), center.y + radius * sin(a1))};
+        b[1] = Point(b[0].x - handle * sin(a0), b[0].y + handle * cos(a0));
+        b[2] = Point(b[3].x + handle * sin(a1), b[3].y - handle * cos(a1));
+        append_cubic(chain, b);
+    }
+}
+
+// Tangent directions at both ends, skipping control points that sit on a knot
+static Point start_tangent(const Point* b) {
+    for (int i = 1; i < 4; i++) {
+        Point t = direction(b[0], b[i]);
+        if (t.x != 0.0 || t.y != 0.0) return t;
+    }
+    return Point(1.0, 0.0);
+}
+
+static Point end_tangent(const Point* b) {
+    for (int i = 2; i >= 0; i--) {
+        Point t = direction(b[i], b[3]);
+        if (t.x != 0.0 || t.y != 0.0) return t;
+    }
+    return Point(1.0, 0.0);
+}
+
+// Left-hand unit normal; the outline runs forward along the left edge
+static Point normal(const Point& tangent) { return Point(-tangent.y, tangent.x); }
+
+static void split_bezier(const Point* b, Point* left, Point* right) {
+    Point ab = mul(add(b[0], b[1]), 0.5), bc = mul(add(b[1], b[2]), 0.5), cd = mul(add(b[2], b[3]), 0.5);
+    Point abc = mul(add(ab, bc), 0.5), bcd = mul(add(bc, cd), 0.5);
+    Point mid = mul(add(abc, bcd), 0.5);
+    left[0] = b[0]; left[1] = ab; left[2] = abc; left[3] = mid;
+    right[0] = mid; right[1] = bcd; right[2] = cd; right[3] = b[3];
+}
+
+// Offset curve of one segment on side `sign` (+1 left, -1 right): knots move
+// along their normals and the handles scale with the chord, which is exact
+// for circular arcs and straight lines
+static void append_offset_segment(StrokePoints& side, const Point* b, double h0, double h3, double sign,
+                                  double tolerance, int depth) {
+    Point n0 = mul(normal(start_tangent(b)), sign);
+    Point n3 = mul(normal(end_tangent(b)), sign);
+    Point o[4] = {add(b[0], mul(n0, h0)), Point(0.0, 0.0), Point(0.0, 0.0), add(b[3], mul(n3, h3))};
+    double chord = length(sub(b[3], b[0]));
+    double k = chord > 1e-9 ? length(sub(o[3], o[0])) / chord : 1.0;
+    o[1] = add(o[0], mul(sub(b[1], b[0]), k));
+    o[2] = add(o[3], mul(sub(b[2], b[3]), k));
+
+    if (depth < MAX_OFFSET_DEPTH) {
+        bool split = false;
+        for (double t : {0.25, 0.5, 0.75}) {
+            Point d = bezier_derivative(b, t);
+            double len = length(d);
+            if (len < 1e-9) continue;
+            // Inside a turn tighter than the half-width the true offset folds
+            // over itself and lies within the stroke anyway
+            Point dd = bezier_second_derivative(b, t);
+            double h = h0 + (h3 - h0) * t;
+            double curvature = (d.x * dd.y - d.y * dd.x) / (len * len * len);
+            if (sign * curvature * h > 1.0) continue;
+            Point n = mul(Point(-d.y / len, d.x / len), sign * h);
+            Point exact = add(bezier_point(b, t), n);
+            if (length(sub(bezier_point(o, t), exact)) > tolerance) {
+                split = true;
+                break;
+            }
+        }
+        if (split) {
+            Point left[4] = {b[0], b[0], b[0], b[0]}, right[4] = {b[0], b[0], b[0], b[0]};
+            split_bezier(b, left, right);
+            double hm = (h0 + h3) / 2.0;
+            append_offset_segment(side, left, h0, hm, sign, tolerance, depth + 1);
+            append_offset_segment(side, right, hm, h3, sign, tolerance, depth + 1);
+            return;
+        }
+    }
+    append_cubic(side, o);
+}
+
+// One side of the outline, front to back
+static StrokePoints offset_side(const StrokePoints& curve, double width, double sign, double tolerance) {
+    StrokePoints side;
+    Point previous_tangent(0.0, 0.0);
+    for (size_t i = 0; i + 3 < curve.size(); i += 3) {
+        Point b[4] = {curve[i], curve[i + 1], curve[i + 2], curve[i + 3]};
+        double h0 = width * curve.width_scale(i) / 2.0;
+        double h3 = width * curve.width_scale(i + 3) / 2.0;
+        Point tangent = start_tangent(b);
+
+        // Corners: round join on the outside, pivot through the knot on the inside
+        if (i > 0 && dot(previous_tangent, tangent) < SMOOTH_JOIN_COS) {
+            double cross = previous_tangent.x * tangent.y - previous_tangent.y * tangent.x;
+            if (sign * cross < 0.0) {
+                Point n = mul(normal(previous_tangent), sign);
+                append_arc(side, b[0], h0, atan2(n.y, n.x), atan2(cross, dot(previous_tangent, tangent)));
+            } else {
+                Point pivot[4] = {b[0], b[0], b[0], b[0]};
+                append_cubic(side, pivot);
+            }
+        }
+
+        append_offset_segment(side, b, h0, h3, sign, tolerance, 0);
+        previous_tangent = end_tangent(b);
+    }
+    return side;
+}
+
+StrokePoints build_bezier_outline(const StrokePoints& curve, double width, double tolerance) {
+    StrokePoints outline;
+    if (curve.empty()) return outline;
+
+    // A single point is a dot
+    if (curve.size() < 4) {
+        append_arc(outline, curve[0], width * curve.width_scale(0) / 2.0, 0.0, 2.0 * M_PI);
+        return outline;
+    }
+
+    size_t last = curve.size() - 4;
+    Point first_segment[4] = {curve[0], curve[1], curve[2], curve[3]};
+    Point last_segment[4] = {curve[last], curve[last + 1], curve[last + 2], curve[last + 3]};
+    Point start_normal = normal(start_tangent(first_segment));
+    Point end_normal = normal(end_tangent(last_segment));
+
+    StrokePoints left = offset_side(curve, width, 1.0, tolerance);
+    StrokePoints right = offset_side(curve, width, -1.0, tolerance);
+
+    // A Bezier chain runs backwards by reading its points in reverse
+    outline.reserve(left.size() + right.size() + 16);
+    for (size_t i = 0; i < left.size(); i++) outline.push_back(left[i]);
+    append_arc(outline, curve[curve.size() - 1], width * curve.width_scale(curve.size() - 1) / 2.0,
+               atan2(end_normal.y, end_normal.x), -M_PI);
+    for (size_t i = right.size() - 1; i >= 3; i -= 3) {
+        Point b[4] = {right[i], right[i - 1], right[i - 2], right[i - 3]};
+        append_cubic(outline, b);
+    }
+    append_arc(outline, curve[0], width * curve.width_scale(0) / 2.0,
+               atan2(-start_normal.y, -start_normal.x), -M_PI);
+    return outline;
+}
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "strokePoints.hpp"
+
+// Default error bound for fitting completed strokes, in device pixels
+constexpr double DEFAULT_FIT_TOLERANCE = 0.5;
+
+// Cubic Bezier paths are stored in a StrokePoints as knot, control, control,
+// knot, control, control, knot, ... (3n + 1 points for n segments). The width
+// scale of the two inner control points is a third of the way between the
+// knots, so evaluating it like a coordinate gives a linear width per segment.
+
+// Number of uniform steps needed to keep the polyline of one cubic Bezier
+// within `tolerance` of the curve (Wang's formula), at least 1.
+int bezier_subdivisions(const Point& b0, const Point& b1, const Point& b2, const Point& b3,
+                        double tolerance, int max_segments);
+
+struct BezierFitResult {
+    StrokePoints curve;
+    double max_error = 0.0;  // Largest deviation of the input points from the curve
+};
+
+// Schneider-style least-squares fit of a polyline to a chain of cubic Beziers
+// with G1 joins. A segment is accepted when every input point lies within
+// `tolerance` of it; the error also counts the change in half-width
+// (width * width_scale / 2), pass width 0 for plain geometry. Sharp turns
+// become corners instead of being smoothed over. A tolerance <= 0 turns
+// every polyline segment into a straight cubic.
+BezierFitResult fit_bezier_path(const StrokePoints& points, double width, double tolerance);
+
+// Polyline through the curve with every step within `tolerance` of it
+StrokePoints flatten_bezier_path(const StrokePoints& curve, double tolerance);
+
+// Whether any part of the curve comes within `radius` of segment a -> b
+// (a point when a == b). With a width the curve's half-width
+// (width * width_scale / 2) counts as well, so the test covers the inked
+// area rather than the centerline.
+bool bezier_path_near(const StrokePoints& curve, const Point& a, const Point& b, double radius, double width = 0.0);
+
+inline bool bezier_path_near(const StrokePoints& curve, double x, double y, double radius, double width = 0.0) {
+    return bezier_path_near(curve, Point(x, y), Point(x, y), radius, width);
+}
+
+// Cuts away every part of the curve whose centerline passes within `radius`
+// of segment a -> b, plus the curve's half-width so the round caps at the
+// cuts stay clear of the eraser. Surviving pieces are appended to `pieces`
+// in order, in the same layout. Returns false, appending nothing, when the
+// curve is untouched; segments whose control box is out of reach are copied
+// without sampling.
+bool bezier_path_erase(const StrokePoints& curve, const Point& a, const Point& b, double radius, double width,
+                       std::vector<StrokePoints>& pieces);
+
+// Closed outline of a fitted centerline as one Bezier chain in the same
+// layout: the offset of every segment on the left side, a round end cap, the
+// right side backwards and a round start cap, with round joins at corners.
+// The half-width is width * width_scale / 2. Offsets are split in half until
+// they stay within `tolerance` of the true offset curve. Fill with the nonzero rule.
+StrokePoints build_bezier_outline(const StrokePoints& curve, double width, double tolerance);
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <type_traits>
+#include <vector>
+
+// Raw native-endian reads and writes for files that never leave this machine
+// (the undo journal). Readers return false once the stream has failed.
+template <typename T>
+void write_value(std::ostream& out, const T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "raw writes need trivially copyable types");
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool read_value(std::istream& in, T& value) {
+    static_assert(std::is_trivially_copyable<T>::value, "raw reads need trivially copyable types");
+    in.read(reinterpret_cast<char*>(&value), sizeof(T));
+    return (bool)in;
+}
+
+// Element count, then the elements
+template <typename T>
+void write_vector(std::ostream& out, const std::vector<T>& values) {
+    write_value(out, (uint64_t)values.size());
+    if (!values.empty()) out.write(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+template <typename T>
+bool read_vector(std::istream& in, std::vector<T>& values) {
+    static_assert(std::is_trivially_copyable<T>::value, "raw reads need trivially copyable types");
+    uint64_t count = 0;
+    if (!read_value(in, count)) return false;
+    values.resize((size_t)count);
+    if (count > 0) in.read(reinterpret_cast<char*>(values.data()), count * sizeof(T));
+    return (bool)in;
+}
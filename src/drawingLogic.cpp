@@ -1,109 +1,187 @@
 #include "drawingLogic.hpp"
 #include <iostream>
 #include <cmath>
+#include <unistd.h>
 
-// Point implementation
-Point::Point(double x, double y) : x(x), y(y) {
-    timestamp = std::chrono::duration_cast<std::chrono::milliseconds>(
-        std::chrono::steady_clock::now().time_since_epoch()).count();
+// Outline width of completed rectangles and circles
+static const double SHAPE_LINE_WIDTH = 2.0;
+
+// Damage padding for antialiasing and the selection highlights drawn around objects
+static const double DAMAGE_MARGIN = 4.0;
+// Past this many damage rectangles their extents are cheaper to clip to
+static const int MAX_DAMAGE_RECTANGLES = 32;
+// Relative scale drift before a resized stroke's preview is rebaked; until
+// then its width is drawn up to this much off what release will bake
+static const double RESIZE_PREVIEW_STEP = 0.05;
+
+static void draw_rect_outline(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& rect) {
+    cr->set_source_rgb(rect.color.r, rect.color.g, rect.color.b);
+    cr->set_line_width(SHAPE_LINE_WIDTH);
+    
+    // Draw rectangle outline
+    cr->rectangle(rect.x, rect.y, rect.width, rect.height);
+    cr->stroke();
 }
 
-// Rect implementation
-Rect::Rect(double x, double y, double width, double height, Color color) : x(x), y(y), width(width), height(height), color(color) {}
+static void draw_circle_outline(const Cairo::RefPtr<Cairo::Context>& cr, const Circle_Data& c) {
+    cr->set_source_rgb(c.color.r, c.color.g, c.color.b);
+    cr->set_line_width(SHAPE_LINE_WIDTH);
 
-// Circle implementaion
-Circle_Data::Circle_Data(double x, double y, double r, Color color) : x(x), y(y), r(r), color(color){}
+    // Draw circle
+    cr->arc(c.x, c.y, c.r, 0, 2 * M_PI);
+    cr->stroke();
+}
 
-// Stroke implementation
-void Stroke::add_point(double x, double y) {
-    raw_points.emplace_back(x, y);
-    
-    // Calculate smooth points in real-time for better UX
-    if (raw_points.size() < 2) {
-        points = raw_points;
-        return;
-    }
-    
-    // Step 1: Light simplification to remove micro-jitter
-    std::vector<Point> simplified;
-    if (raw_points.size() <= 2) {
-        simplified = raw_points;
-    } else {
-        simplified.push_back(raw_points[0]); // Always keep first point
-        
-        for (size_t i = 1; i < raw_points.size() - 1; i++) {
-            const Point& prev = simplified.back();
-            const Point& current = raw_points[i];
-            
-            // Calculate distance from current point to previous point
-            double dx = current.x - prev.x;
-            double dy = current.y - prev.y;
-            double dist = sqrt(dx * dx + dy * dy);
-            
-            // Keep point if it's far enough from the previous point
-            if (dist >= 0.5) {
-                simplified.push_back(current);
-            }
-        }
-        
-        simplified.push_back(raw_points.back()); // Always keep last point
+// Painted area of a shape outline; rectangles dragged up or left have negative sizes
+static BoundingBox rect_bounds(const Rect& rect) {
+    double pad = SHAPE_LINE_WIDTH / 2.0;
+    return BoundingBox(std::min(rect.x, rect.x + rect.width) - pad, std::min(rect.y, rect.y + rect.height) - pad,
+                       std::abs(rect.width) + 2 * pad, std::abs(rect.height) + 2 * pad);
+}
+
+static BoundingBox circle_bounds(const Circle_Data& c) {
+    double extent = c.r + SHAPE_LINE_WIDTH / 2.0;
+    return BoundingBox(c.x - extent, c.y - extent, 2 * extent, 2 * extent);
+}
+
+// Offscreen layer addressed in widget coordinates but backed by device pixels,
+// so it is as sharp as drawing straight onto the widget on HiDPI outputs
+static Cairo::RefPtr<Cairo::ImageSurface> create_layer_surface(int width, int height, int scale) {
+    auto surface = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, width * scale, height * scale);
+    surface->set_device_scale(scale, scale);
+    return surface;
+}
+
+// Writes an axis-aligned transform into geometry the way resizing always has:
+// strokes scale their width and circles their radius by the smaller factor.
+// Rotation and shear can't be expressed, so those return false untouched.
+static bool bake_geometry(Stroke& stroke, const Affine& m) {
+    if (!m.is_axis_aligned()) return false;
+    // Stroke rescales its own box, so refetching it stays O(1); a plain move only shifts origins
+    if (m.xx != 1.0 || m.yy != 1.0) stroke.scale(m.xx, m.yy, 0.0, 0.0);
+    stroke.translate(m.x0, m.y0);
+    return true;
+}
+
+static bool bake_geometry(Rect& rect, const Affine& m) {
+    if (!m.is_axis_aligned()) return false;
+    rect.x = m.xx * rect.x + m.x0;
+    rect.y = m.yy * rect.y + m.y0;
+    rect.width *= m.xx;
+    rect.height *= m.yy;
+    return true;
+}
+
+static bool bake_geometry(Circle_Data& c, const Affine& m) {
+    if (!m.is_axis_aligned()) return false;
+    c.x = m.xx * c.x + m.x0;
+    c.y = m.yy * c.y + m.y0;
+    c.r *= std::min(std::abs(m.xx), std::abs(m.yy)); // Keep circle round
+    return true;
+}
+
+static Cairo::Matrix cairo_matrix(const Affine& m) {
+    return Cairo::Matrix(m.xx, m.yx, m.xy, m.yy, m.x0, m.y0);
+}
+
+static BoundingBox merge_bounds(const BoundingBox& a, const BoundingBox& b) {
+    double x1 = std::min(a.x, b.x), y1 = std::min(a.y, b.y);
+    double x2 = std::max(a.x + a.width, b.x + b.width), y2 = std::max(a.y + a.height, b.y + b.height);
+    return BoundingBox(x1, y1, x2 - x1, y2 - y1);
+}
+
+// Distance the pointer travels before the lasso gets another vertex
+static const double LASSO_MIN_SPACING = 2.0;
+// Sides of the polygon standing in for a circle outline in lasso tests
+static const int LASSO_CIRCLE_SEGMENTS = 32;
+
+static BoundingBox triangle_bounds(const Point& a, const Point& b, const Point& c) {
+    double x1 = std::min(a.x, std::min(b.x, c.x)), y1 = std::min(a.y, std::min(b.y, c.y));
+    double x2 = std::max(a.x, std::max(b.x, c.x)), y2 = std::max(a.y, std::max(b.y, c.y));
+    return BoundingBox(x1, y1, x2 - x1, y2 - y1);
+}
+
+// Whether a polyline (closed for shape outlines) meets the lasso under `policy`
+template <typename Points>
+static bool polyline_in_lasso(const LassoPolygon& lasso, const Points& points, bool closed, LassoPolicy policy) {
+    size_t n = points.size();
+    if (n == 0) return false;
+    bool contained = policy == LassoPolicy::CONTAINED;
+    for (size_t i = 0; i < n; i++) {
+        bool inside = lasso.contains(points[i]);
+        if (inside != contained) return inside;
     }
     
-    // Step 2: Catmull-Rom interpolation for ultra-smooth curves
-    if (simplified.size() < 2) {
-        points = simplified;
-    } else if (simplified.size() == 2) {
-        points = simplified;
-    } else {
-        points.clear();
-        points.reserve(simplified.size() * 12);
-        
-        // Add first point
-        points.push_back(simplified[0]);
-        
-        // Interpolate between each consecutive pair of points
-        for (size_t i = 0; i < simplified.size() - 1; i++) {
-            // Get the four control points for Catmull-Rom spline
-            Point p0 = (i > 0) ? simplified[i-1] : simplified[i];
-            Point p1 = simplified[i];
-            Point p2 = simplified[i+1];
-            Point p3 = (i+2 < simplified.size()) ? simplified[i+2] : simplified[i+1];
-            
-            // Generate many interpolated points for super smooth curves
-            for (int j = 1; j <= 12; j++) {
-                double t = (double)j / 12;
-                double t2 = t * t;
-                double t3 = t2 * t;
-                
-                // Catmull-Rom spline formula
-                double x = 0.5 * ((2.0 * p1.x) +
-                                 (-p0.x + p2.x) * t +
-                                 (2.0 * p0.x - 5.0 * p1.x + 4.0 * p2.x - p3.x) * t2 +
-                                 (-p0.x + 3.0 * p1.x - 3.0 * p2.x + p3.x) * t3);
-                
-                double y = 0.5 * ((2.0 * p1.y) +
-                                 (-p0.y + p2.y) * t +
-                                 (2.0 * p0.y - 5.0 * p1.y + 4.0 * p2.y - p3.y) * t2 +
-                                 (-p0.y + 3.0 * p1.y - 3.0 * p2.y + p3.y) * t3);
-                
-                points.emplace_back(x, y);
-            }
-        }
+    // Every vertex is on the same side, but an edge can still cross the loop
+    size_t edges = closed ? n : n - 1;
+    for (size_t i = 0; i < edges; i++) {
+        if (lasso.crosses_segment(points[i], points[(i + 1) % n])) return !contained;
     }
+    return contained;
+}
+
+static std::vector<Point> rect_outline(const Rect& rect) {
+    return {Point(rect.x, rect.y), Point(rect.x + rect.width, rect.y),
+            Point(rect.x + rect.width, rect.y + rect.height), Point(rect.x, rect.y + rect.height)};
 }
 
-// Rectangle implementation
-void Rectangle::add_rect(double x, double y, double width, double height, Color color) {
-    rects.emplace_back(x, y, width, height, color);
+static std::vector<Point> circle_outline(const Circle_Data& c) {
+    std::vector<Point> outline;
+    outline.reserve(LASSO_CIRCLE_SEGMENTS);
+    for (int i = 0; i < LASSO_CIRCLE_SEGMENTS; i++) {
+        double angle = 2 * M_PI * i / LASSO_CIRCLE_SEGMENTS;
+        outline.push_back(Point(c.x + c.r * cos(angle), c.y + c.r * sin(angle)));
+    }
+    return outline;
 }
 
-// Circle implementation
-void Circle::add_circle(double x, double y, double r, Color color){
-    circles.emplace_back(x, y, r, color);
+// How far past its bounding box a picking hit test can reach (find_object_at_point)
+static const double OBJECT_HIT_SLOP = 2.0;
+// Tolerance is_point_in_stroke uses when grabbing a selection
+static const double STROKE_GRAB_TOLERANCE = 5.0;
+
+// Margin around a lifted selection's bounds for the highlight outline
+static const double LIFT_MARGIN = 6.0;
+
+// Edge length of the resize handles around the selection
+static const double SELECTION_HANDLE_SIZE = 8.0;
+
+// Rect implementation
+Rect::Rect(double x, double y, double width, double height, Color color) : x(x), y(y), width(width), height(height), color(color) {}
+
+// Circle implementaion
+Circle_Data::Circle_Data(double x, double y, double r, Color color) : x(x), y(y), r(r), color(color){}
+
+// Stroke implementation
+void Stroke::add_point(const InputSample& sample) {
+    // Only raw input samples are timestamped, as 32-bit deltas from the first one
+    // (unsigned subtraction keeps the delta correct across device clock wrap-around)
+    if (sample_times.empty()) start_time = sample.time;
+    sample_times.push_back(sample.time - start_time);
+    
+    // Calculate smooth points in real-time for better UX; only the tail
+    // of the spline that depends on the newest sample is recomputed
+    smoother.add_sample(Point(sample.x, sample.y), points, pen_width_scale(sample));
+}
+
+size_t Stroke::add_samples(const std::vector<InputSample>& samples, double min_distance) {
+    size_t added = 0;
+    for (const auto& sample : samples) {
+        // Skip samples that haven't moved far enough from the last one
+        if (!points.empty()) {
+            Point last = points.back();
+            double dx = sample.x - last.x;
+            double dy = sample.y - last.y;
+            if (dx * dx + dy * dy < min_distance * min_distance) continue;
+        }
+        add_point(sample);
+        added++;
+    }
+    return added;
 }
 
 // Cairo Drawing Area implementation
-CairoDrawingArea::CairoDrawingArea() : is_drawing(false), is_drawing_rectangle(false), is_drawing_circle(false), is_erasing(false), is_selecting(false), is_moving(false), is_moving_selection(false), is_resizing(false), rectangle_start(0, 0), current_mouse_pos(0, 0), circle_start(0, 0), selection_start(0, 0), current_handle(HandlePosition::NONE), last_redraw_time(std::chrono::steady_clock::now())
+CairoDrawingArea::CairoDrawingArea() : is_drawing(false), is_drawing_rectangle(false), is_drawing_circle(false), is_erasing(false), is_selecting(false), is_lassoing(false), is_moving(false), is_moving_selection(false), is_resizing(false), rectangle_start(0, 0), current_mouse_pos(0, 0), circle_start(0, 0), selection_start(0, 0), last_eraser_pos(0, 0), current_handle(HandlePosition::NONE), last_redraw_time(std::chrono::steady_clock::now())
 {
     set_size_request(800, 600);
     
@@ -116,6 +194,17 @@ CairoDrawingArea::CairoDrawingArea() : is_drawing(false), is_drawing_rectangle(f
     auto cursor = Gdk::Cursor::create("default");
     set_cursor(cursor);
     
+    // Takes keyboard focus on click for the selection shortcuts
+    set_focusable(true);
+    
+    // Undo history past the in-memory window is journaled here, one file pair per process;
+    // a fresh account may not have a cache directory yet
+    std::string cache_dir = Glib::get_user_cache_dir();
+    std::string journal = Glib::build_filename(cache_dir, "inkdraw-" + std::to_string(getpid()));
+    if (g_mkdir_with_parents(cache_dir.c_str(), 0700) != 0 || !history.open_journal(journal)) {
+        std::cout << "Undo journal unavailable at " << journal << ", keeping history in memory" << std::endl;
+    }
+    
     setup_input_handling();
 }
 
@@ -129,91 +218,87 @@ void CairoDrawingArea::setup_input_handling() {
     auto motion_controller = Gtk::EventControllerMotion::create();
     auto click_gesture = Gtk::GestureClick::create();
     
+    // Raw pointers: the controllers are owned by this widget
+    auto motion = motion_controller.get();
+    auto click = click_gesture.get();
+    
     // Mouse press - start drawing
-    click_gesture->signal_pressed().connect([this](int n_press, double x, double y){
+    click_gesture->signal_pressed().connect([this, click](int n_press, double x, double y){
+        grab_focus();
         if(current_tool == "pen"){ 
             is_drawing = true;
             current_stroke = Stroke(current_pen_width, current_pen_color);
-            current_stroke.add_point(x, y);
+            current_stroke.set_flatness_tolerance(flatness_tolerance());
+            current_stroke.add_point(sample_from_event(*click, x, y));
+            live_stable_points = 0;
+            live_tail_bounds = BoundingBox();
+            begin_wet_ink();
         }
         else if(current_tool == "rectangle") {
             is_drawing_rectangle = true;
             rectangle_start = Point(x, y);
-            current_rectangle = Rectangle();
+            current_mouse_pos = Point(x, y);
         }
         else if(current_tool == "circle"){
              is_drawing_circle = true;
              circle_start = Point(x, y);
-             current_circle = Circle();
+             current_mouse_pos = Point(x, y);
         }
         else if(current_tool == "eraser") {
             is_erasing = true;
             // Don't clear the vectors here - they'll be cleared on mouse release
+            last_eraser_pos = Point(x, y);
+            current_eraser.begin(scene.id_limit());
+            update_eraser_collision(last_eraser_pos, last_eraser_pos);
+            queue_damage();
         }
         else if(current_tool == "select") {
             // Check if clicking on an already selected object to start moving
-            bool clicked_on_selected = false;
-            
-            // Check strokes
-            for (int i = 0; i < completed_strokes.size(); i++) {
-                if (std::find(selected_stroke_indices.begin(), selected_stroke_indices.end(), i) != selected_stroke_indices.end()) {
-                    if (is_point_in_stroke(completed_strokes[i], x, y)) {
-                        clicked_on_selected = true;
-                        break;
-                    }
-                }
-            }
-            
-            if (!clicked_on_selected) {
-                // Check rectangles
-                for (int i = 0; i < completed_rectangles.size(); i++) {
-                    if (std::find(selected_rectangle_indices.begin(), selected_rectangle_indices.end(), i) != selected_rectangle_indices.end()) {
-                        for (const auto& rect : completed_rectangles[i].rects) {
-                            if (is_point_in_rectangle(rect, x, y)) {
-                                clicked_on_selected = true;
-                                break;
-                            }
-                        }
-                        if (clicked_on_selected) break;
-                    }
-                }
-            }
-            
-            if (!clicked_on_selected) {
-                // Check circles
-                for (int i = 0; i < completed_circles.size(); i++) {
-                    if (std::find(selected_circle_indices.begin(), selected_circle_indices.end(), i) != selected_circle_indices.end()) {
-                        for (const auto& circle : completed_circles[i].circles) {
-                            if (is_point_in_circle(circle, x, y)) {
-                                clicked_on_selected = true;
-                                break;
-                            }
-                        }
-                        if (clicked_on_selected) break;
-                    }
-                }
-            }
+            HandlePosition handle = find_handle_at_point(x, y);
+            bool clicked_on_selected = handle == HandlePosition::NONE && is_point_on_selection(x, y);
             
-            if (clicked_on_selected) {
+            if (handle != HandlePosition::NONE) {
+                // Handles resize the whole selection
+                start_resize_operation(x, y, handle);
+            } else if (clicked_on_selected) {
                 // Start moving selected objects
                 is_moving_selection = true;
                 selection_start = Point(x, y);
+                moved_dx = moved_dy = 0.0;
             } else {
                 // Start selection rectangle or clear selection
                 is_selecting = true;
                 selection_start = Point(x, y);
+                current_mouse_pos = Point(x, y);
+                clear_all_selections();
+                queue_full_draw(); // Highlights can be anywhere
+            }
+        }
+        else if(current_tool == "lasso") {
+            HandlePosition handle = find_handle_at_point(x, y);
+            if (handle != HandlePosition::NONE) {
+                start_resize_operation(x, y, handle);
+            } else if (is_point_on_selection(x, y)) {
+                // Lasso selections move the same way
+                is_moving_selection = true;
+                selection_start = Point(x, y);
+                moved_dx = moved_dy = 0.0;
+            } else {
+                is_lassoing = true;
+                lasso_points.assign(1, Point(x, y));
                 clear_all_selections();
+                queue_full_draw(); // Highlights can be anywhere
             }
         }
     });
     
     // Mouse motion - add points while drawing
-    motion_controller->signal_motion().connect([this](double x, double y){
+    motion_controller->signal_motion().connect([this, motion](double x, double y){
         if (is_drawing) {
-            // Reduce threshold for much denser point collection
-            if (current_stroke.points.empty() || 
-                point_distance(current_stroke.points.back(), Point(x, y)) >= 0.5) {
-                current_stroke.add_point(x, y);
+            // Feed every sample coalesced into this event, not just the final position
+            if (current_stroke.add_samples(collect_motion_samples(*motion, x, y)) > 0) {
+                // Damage accumulates every event even when the redraw is throttled
+                damage_live_stroke();
                 
                 // Frame rate limiting: only redraw at 60fps max (16.67ms intervals)
                 auto now = std::chrono::steady_clock::now();
@@ -224,134 +309,280 @@ void CairoDrawingArea::setup_input_handling() {
                 }
             }
         }else if(current_tool == "eraser" && is_erasing){
-            // Erase items on contact and add to preview
-            update_eraser_collision(x, y);
-            queue_draw(); // Trigger redraw
+            // Erase items the eraser swept over since the last event and add to preview
+            Point eraser_pos(x, y);
+            update_eraser_collision(last_eraser_pos, eraser_pos);
+            last_eraser_pos = eraser_pos;
+            queue_damage(); // Only erased objects changed
         }
         else if (is_drawing_rectangle || is_drawing_circle) {
-            // Update current mouse position for rectangle preview
+            // Update current mouse position for rectangle preview; repaint old and new preview
+            damage_area(preview_bounds());
             current_mouse_pos = Point(x, y);
-            queue_draw(); // Trigger redraw to show preview
+            damage_area(preview_bounds());
+            queue_damage(); // Trigger redraw to show preview
         }
-        else if (current_tool == "select") {
+        else if (current_tool == "select" || current_tool == "lasso") {
             if (is_selecting) {
+                damage_area(preview_bounds());
                 current_mouse_pos = Point(x, y);
-                queue_draw();
+                damage_area(preview_bounds());
+                queue_damage();
+            } else if (is_lassoing) {
+                Point p(x, y);
+                if (distance_squared(p, lasso_points.back()) >= LASSO_MIN_SPACING * LASSO_MIN_SPACING) {
+                    // The fill only changes in the triangle between the first point and the old and new ends
+                    damage_area(triangle_bounds(lasso_points.front(), lasso_points.back(), p));
+                    lasso_points.push_back(p);
+                    queue_damage();
+                }
             } else if (is_moving_selection) {
                 double dx = x - selection_start.x;
                 double dy = y - selection_start.y;
                 move_selected_objects(dx, dy);
                 selection_start = Point(x, y);
-                queue_draw();
+                queue_damage();
+            } else if (is_resizing) {
+                perform_resize(x, y);
+                queue_damage();
             }
         }
     });
     
     // Mouse release - finish drawing
-    click_gesture->signal_released().connect([this](int n_press, double x, double y){
+    click_gesture->signal_released().connect([this, click](int n_press, double x, double y){
         if (is_drawing) {
-            current_stroke.add_point(x, y);
-            // Complete stroke and render to background surface (like SVG layer)
-            current_stroke.complete_stroke();
-            render_stroke_to_background(current_stroke);
+            current_stroke.add_point(sample_from_event(*click, x, y));
+            damage_area(current_stroke.get_bounds());
+            // Move the wet ink into the background tiles as it is; the fitted
+            // outline is only rendered when one of those tiles is rebuilt
+            commit_wet_ink();
+            
+            // Complete stroke (the fitted curve is the stored format)
+            current_stroke.complete_stroke(fit_tolerance());
             
-            // Optional: keep in vector for other features (eraser, selection, etc.)
-            completed_strokes.push_back(current_stroke);
+            // Keep it in the scene for other features (eraser, selection, etc.)
+            ObjectId id = scene.add_stroke(current_stroke);
+            history.record(SceneEdit{SceneEdit::Type::ADD, {id}});
             
             current_stroke = Stroke(current_pen_width, current_pen_color); // Reset with current settings
             if(current_tool == "pen" && is_drawing == true)is_drawing = false;
-            queue_draw();
+            queue_damage();
         }
         else if (is_drawing_rectangle) {
             // Calculate rectangle dimensions
             double width = x - rectangle_start.x;
             double height = y - rectangle_start.y;
             
-            // Add rectangle to current rectangle object
-            current_rectangle.add_rect(rectangle_start.x, rectangle_start.y, width, height, default_rectangle_color);
+            Rect rect(rectangle_start.x, rectangle_start.y, width, height, default_rectangle_color);
+            damage_area(preview_bounds());
             
-            // Render to background surface before adding to vector
-            render_rectangle_to_background(current_rectangle);
-            completed_rectangles.push_back(current_rectangle);
+            // Render to background surface before adding to the scene
+            render_rectangle_to_background(rect);
+            history.record(SceneEdit{SceneEdit::Type::ADD, {scene.add_rectangle(rect)}});
             
-            // Clear current rectangle
-            current_rectangle = Rectangle();
             is_drawing_rectangle = false;
-            queue_draw();
+            queue_damage();
         }
         else if(is_drawing_circle){
             double r = sqrt(pow(x - circle_start.x, 2) + pow(y - circle_start.y, 2));
 
-            current_circle.add_circle(circle_start.x, circle_start.y, r, default_circle_color);
+            Circle_Data circle(circle_start.x, circle_start.y, r, default_circle_color);
+            damage_area(preview_bounds());
             
-            // Render to background surface before adding to vector
-            render_circle_to_background(current_circle);
-            completed_circles.push_back(current_circle);
+            // Render to background surface before adding to the scene
+            render_circle_to_background(circle);
+            history.record(SceneEdit{SceneEdit::Type::ADD, {scene.add_circle(circle)}});
 
-            current_circle = Circle();
             is_drawing_circle = false;
-            queue_draw();
+            queue_damage();
         }
         else if (is_erasing) {
-            // Stop erasing mode and clear preview vectors
-            current_eraser.stroke_to_erase.clear();
-            current_eraser.rectangle_to_erase.clear();
-            current_eraser.circle_to_erase.clear();
+            // Stop erasing mode and drop the staged objects for good
+            finish_erasing();
             is_erasing = false;
-            queue_draw();
+            queue_damage();
         }
-        else if (current_tool == "select") {
+        else if (current_tool == "select" || current_tool == "lasso") {
             if (is_selecting) {
                 // Complete selection rectangle
                 select_objects_in_rectangle(selection_start.x, selection_start.y, x, y);
                 is_selecting = false;
+                queue_full_draw(); // New highlights
+            } else if (is_lassoing) {
+                select_objects_in_lasso();
+                is_lassoing = false;
+                lasso_points.clear();
+                queue_full_draw(); // New highlights, lasso gone
             } else if (is_moving_selection) {
                 // Complete move operation
+                drop_selection();
+                record_transform();
                 is_moving_selection = false;
+                queue_damage();
+            } else if (is_resizing) {
+                finish_resize();
+                queue_damage();
             }
-            queue_draw();
         }
     });
     
+    // Ctrl+Z undoes, Ctrl+Shift+Z or Ctrl+Y redoes; with the select or lasso
+    // tool, Ctrl+A selects everything and Ctrl+I inverts the selection
+    auto key_controller = Gtk::EventControllerKey::create();
+    key_controller->signal_key_pressed().connect([this](guint keyval, guint keycode, Gdk::ModifierType state) {
+        if ((state & Gdk::ModifierType::CONTROL_MASK) != Gdk::ModifierType::CONTROL_MASK) return false;
+        if (is_drawing || is_drawing_rectangle || is_drawing_circle || is_erasing || is_moving || is_resizing || is_moving_selection) return false;
+        if (keyval == GDK_KEY_z || keyval == GDK_KEY_Z) {
+            if ((state & Gdk::ModifierType::SHIFT_MASK) == Gdk::ModifierType::SHIFT_MASK) redo();
+            else undo();
+            return true;
+        }
+        if (keyval == GDK_KEY_y) {
+            redo();
+            return true;
+        }
+        if (current_tool != "select" && current_tool != "lasso") return false;
+        if (keyval == GDK_KEY_a) {
+            select_all();
+            return true;
+        }
+        if (keyval == GDK_KEY_i) {
+            invert_selection();
+            return true;
+        }
+        return false;
+    }, false);
+    
     add_controller(motion_controller);
     add_controller(click_gesture);
+    add_controller(key_controller);
+}
+
+InputSample CairoDrawingArea::sample_from_event(const Gtk::EventController& controller, double x, double y) {
+    InputSample sample{x, y, controller.get_current_event_time()};
+    auto event = controller.get_current_event();
+    if (!event) return sample;
+    
+    // Stylus axes; absent on plain mice, which keep the nominal width
+    double value;
+    if (event->get_axis(Gdk::AxisUse::PRESSURE, value)) sample.pressure = value;
+    if (event->get_axis(Gdk::AxisUse::XTILT, value)) sample.tilt_x = value;
+    if (event->get_axis(Gdk::AxisUse::YTILT, value)) sample.tilt_y = value;
+    return sample;
+}
+
+std::vector<InputSample> CairoDrawingArea::collect_motion_samples(const Gtk::EventController& controller, double x, double y) {
+    std::vector<InputSample> samples;
+    InputSample current = sample_from_event(controller, x, y);
+    auto event = controller.get_current_event();
+    if (!event) {
+        samples.push_back(current);
+        return samples;
+    }
+    double unused;
+    bool has_pressure = event->get_axis(Gdk::AxisUse::PRESSURE, unused);
+    bool has_tilt = event->get_axis(Gdk::AxisUse::XTILT, unused);
+    
+    // History coordinates are surface-relative while (x, y) is widget-relative
+    double event_x = x, event_y = y;
+    event->get_position(event_x, event_y);
+    double offset_x = x - event_x;
+    double offset_y = y - event_y;
+    
+    // Intermediate device samples GTK coalesced into this event, oldest first
+    for (const auto& coord : event->get_history()) {
+        InputSample sample{coord.get_value_at_axis(Gdk::AxisUse::X) + offset_x,
+                           coord.get_value_at_axis(Gdk::AxisUse::Y) + offset_y,
+                           coord.get_time()};
+        if (has_pressure) sample.pressure = coord.get_value_at_axis(Gdk::AxisUse::PRESSURE);
+        if (has_tilt) {
+            sample.tilt_x = coord.get_value_at_axis(Gdk::AxisUse::XTILT);
+            sample.tilt_y = coord.get_value_at_axis(Gdk::AxisUse::YTILT);
+        }
+        samples.push_back(sample);
+    }
+    samples.push_back(current);
+    return samples;
 }
 
 void CairoDrawingArea::on_draw(const Cairo::RefPtr<Cairo::Context>& cr, int width, int height) {
-    // Ensure background surface matches current size
-    if (!background_surface || background_surface->get_width() != width || background_surface->get_height() != height) {
+    // Ensure the tile grid covers the current size; only newly exposed tiles get rendered
+    int scale = std::max(1, get_scale_factor());
+    if (background_tiles.get_width() != width || background_tiles.get_height() != height ||
+        background_tiles.get_scale() != scale) {
         initialize_background_surface(width, height);
-        rebuild_background_surface(); // Re-render all objects to new surface
     }
+    flush_eraser_invalidation();
+    update_background_tiles();
+    if (is_drawing) update_wet_ink();
+    
+    if (!frame_surface || frame_surface->get_width() != width * scale || frame_surface->get_height() != height * scale) {
+        frame_surface = create_layer_surface(width, height, scale);
+        frame_context = Cairo::Context::create(frame_surface);
+        full_damage = true;
+    }
+    
+    // A draw GTK asked for on its own carries no damage of ours: repaint everything
+    if (full_damage || !damage || damage->empty()) {
+        damage = Cairo::Region::create(Cairo::RectangleInt{0, 0, width, height});
+    } else if (damage->get_num_rectangles() > MAX_DAMAGE_RECTANGLES) {
+        damage = Cairo::Region::create(damage->get_extents());
+    }
+    
+    frame_context->save();
+    for (int i = 0; i < damage->get_num_rectangles(); i++) {
+        Cairo::RectangleInt r = damage->get_rectangle(i);
+        frame_context->rectangle(r.x, r.y, r.width, r.height);
+    }
+    frame_context->clip();
+    draw_frame(frame_context);
+    frame_context->restore();
+    
+    damage = Cairo::Region::create();
+    full_damage = false;
     
-    // Clear background
-    cr->set_source_rgba(0, 0, 0, 0); // Transparent background
+    // GTK 4 has no partial widget invalidation, so the retained frame is presented with one blit
+    cr->set_source(frame_surface, 0, 0);
     cr->paint();
+}
+
+void CairoDrawingArea::draw_frame(const Cairo::RefPtr<Cairo::Context>& cr) {
+    // Clear background (the retained frame still holds the previous contents)
+    cr->save();
+    cr->set_operator(Cairo::Context::Operator::CLEAR); // Transparent background
+    cr->paint();
+    cr->restore();
+    
+    // PERFORMANCE FIX: Blit cached background tiles (contain all completed objects)
+    background_tiles.paint(cr);
     
-    // PERFORMANCE FIX: Blit cached background surface (contains all completed objects)
-    if (background_surface) {
-        cr->set_source(background_surface, 0, 0);
+    // Draw selection highlights on live layer (overlay on top of background);
+    // a selection being dragged is one blit, highlights included
+    if (is_lifted) {
+        cr->set_source(lifted_surface, lifted_bounds.x + moved_dx, lifted_bounds.y + moved_dy);
         cr->paint();
+    } else {
+        // A selection being resized is left out of the tiles and drawn live through its transforms
+        draw_resize_previews(cr);
+        draw_selection_highlights(cr);
+    }
+    if ((current_tool == "select" || current_tool == "lasso") && !is_lifted && !is_selecting && !is_lassoing) {
+        draw_selection_handles(cr);
     }
-    
-    // Draw selection highlights on live layer (overlay on top of background)
-    draw_selection_highlights(cr);
     
     // Draw selection rectangle if selecting
     if (current_tool == "select" && is_selecting) {
         draw_selection_rectangle(cr, selection_start.x, selection_start.y, current_mouse_pos.x, current_mouse_pos.y);
     }
     
-    // Draw unified drawable objects (for future use)
-    for (const auto& obj : drawable_objects) {
-        if (obj->is_selected) {
-            obj->draw_selection_handles(cr);
-        }
+    if (is_lassoing) {
+        draw_lasso(cr);
     }
     
-    // Draw current stroke if drawing - points are already smooth in real-time
+    // Draw current stroke if drawing: the wet layer plus its live tail
     if (is_drawing && !current_stroke.points.empty()) {
-        draw_stroke(cr, current_stroke);
+        draw_wet_ink(cr);
     }
     
     // Draw rectangle preview if drawing rectangle
@@ -365,32 +596,40 @@ void CairoDrawingArea::on_draw(const Cairo::RefPtr<Cairo::Context>& cr, int widt
         draw_circle_preview(cr, circle_start.x, circle_start.y, r);
     }
     
-    // Draw erasing preview if actively erasing
+    // Draw erasing preview if actively erasing: the staged objects, dimmed
     if (is_erasing) {
-        for (const auto& stroke : current_eraser.stroke_to_erase) {
-            draw_erasing_preview(cr, stroke);
-        }
-        for (const auto& rect : current_eraser.rectangle_to_erase) {
-            // Draw rectangle with 50% transparency
-            cr->set_source_rgba(rect.color.r, rect.color.g, rect.color.b, 0.5);
-            cr->set_line_width(2.0);
-            cr->rectangle(rect.x, rect.y, rect.width, rect.height);
-            cr->stroke();
-        }
-
-        for (const auto& c : current_eraser.circle_to_erase){
-            // Draw circle with 50% transparency
-            cr->set_source_rgba(c.color.r, c.color.g, c.color.b, 0.5);
-            cr->set_line_width(2.0);
-            cr->arc(c.x, c.y, c.r, 0, 2 * M_PI);
-            cr->stroke();
+        for (ObjectId id : current_eraser.erased) {
+            switch (scene.kind(id)) {
+                case ObjectKind::STROKE:
+                    // Strokes being split have no dimmed copy: their pieces are already in the background
+                    if (!current_eraser.is_partial()) draw_erasing_preview(cr, scene.stroke(id));
+                    break;
+                case ObjectKind::RECTANGLE: {
+                    // Draw rectangle with 50% transparency
+                    const Rect& rect = scene.rect(id);
+                    cr->set_source_rgba(rect.color.r, rect.color.g, rect.color.b, 0.5);
+                    cr->set_line_width(2.0);
+                    cr->rectangle(rect.x, rect.y, rect.width, rect.height);
+                    cr->stroke();
+                    break;
+                }
+                case ObjectKind::CIRCLE: {
+                    // Draw circle with 50% transparency
+                    const Circle_Data& c = scene.circle(id);
+                    cr->set_source_rgba(c.color.r, c.color.g, c.color.b, 0.5);
+                    cr->set_line_width(2.0);
+                    cr->arc(c.x, c.y, c.r, 0, 2 * M_PI);
+                    cr->stroke();
+                    break;
+                }
+            }
         }
     }
     
 }
 
 void CairoDrawingArea::draw_stroke(const Cairo::RefPtr<Cairo::Context>& cr, const Stroke& stroke) {
-    if (stroke.points.size() < 2) return;
+    if (!stroke.is_fitted() && stroke.points.size() < 2) return;
     
     // Use smooth stroke rendering for better quality
     draw_smooth_stroke(cr, stroke);
@@ -417,26 +656,62 @@ void CairoDrawingArea::draw_current_stroke_simple(const Cairo::RefPtr<Cairo::Con
     cr->stroke();
 }
 
-void CairoDrawingArea::draw_rectangle(const Cairo::RefPtr<Cairo::Context>& cr, const Rectangle& rectangle) {
-    for (const auto& rect : rectangle.rects) {
-        cr->set_source_rgb(rect.color.r, rect.color.g, rect.color.b);
-        cr->set_line_width(2.0);
-        
-        // Draw rectangle outline
-        cr->rectangle(rect.x, rect.y, rect.width, rect.height);
-        cr->stroke();
-    }
+void CairoDrawingArea::draw_rectangle(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& rect) {
+    draw_rect_outline(cr, rect);
 }
 
-void CairoDrawingArea::draw_circle(const Cairo::RefPtr<Cairo::Context>& cr, const Circle& circle){
-    for(const auto& c : circle.circles){
-        cr->set_source_rgb(c.color.r, c.color.g, c.color.b);
-        cr->set_line_width(2.0);
+void CairoDrawingArea::draw_circle(const Cairo::RefPtr<Cairo::Context>& cr, const Circle_Data& circle){
+    draw_circle_outline(cr, circle);
+}
 
-        // Draw circle
-        cr->arc(c.x, c.y, c.r, 0, 2 * M_PI);
-        cr->stroke();
+void CairoDrawingArea::draw_object(const Cairo::RefPtr<Cairo::Context>& cr, ObjectId id) {
+    const Affine& m = scene.transform(id);
+    if (m.is_identity()) {
+        switch (scene.kind(id)) {
+            case ObjectKind::STROKE: draw_smooth_stroke(cr, scene.stroke(id)); break;
+            case ObjectKind::RECTANGLE: draw_rect_outline(cr, scene.rect(id)); break;
+            case ObjectKind::CIRCLE: draw_circle_outline(cr, scene.circle(id)); break;
+        }
+        return;
+    }
+    
+    // Pending transform: draw a baked copy so the object looks exactly as it
+    // will once baked (a stroke's width must not stretch with a non-uniform
+    // scale); only transforms that can't be baked go through the matrix
+    switch (scene.kind(id)) {
+        case ObjectKind::STROKE: {
+            Stroke stroke = scene.stroke(id);
+            if (bake_geometry(stroke, m)) {
+                draw_smooth_stroke(cr, stroke);
+                return;
+            }
+            break;
+        }
+        case ObjectKind::RECTANGLE: {
+            Rect rect = scene.rect(id);
+            if (bake_geometry(rect, m)) {
+                draw_rect_outline(cr, rect);
+                return;
+            }
+            break;
+        }
+        case ObjectKind::CIRCLE: {
+            Circle_Data circle = scene.circle(id);
+            if (bake_geometry(circle, m)) {
+                draw_circle_outline(cr, circle);
+                return;
+            }
+            break;
+        }
     }
+    cr->save();
+    cr->transform(cairo_matrix(m));
+    switch (scene.kind(id)) {
+        case ObjectKind::STROKE: draw_smooth_stroke(cr, scene.stroke(id)); break;
+        case ObjectKind::RECTANGLE: draw_rect_outline(cr, scene.rect(id)); break;
+        case ObjectKind::CIRCLE: draw_circle_outline(cr, scene.circle(id)); break;
+    }
+    cr->restore();
 }
 
 void CairoDrawingArea::draw_circle_preview(const Cairo::RefPtr<Cairo::Context>& cr, double start_x, double start_y, double r){
@@ -460,23 +735,28 @@ void CairoDrawingArea::draw_rectangle_preview(const Cairo::RefPtr<Cairo::Context
 }
 
 void CairoDrawingArea::draw_smooth_stroke(const Cairo::RefPtr<Cairo::Context>& cr, const Stroke& stroke) {
-    if (stroke.points.size() < 2) return;
+    if (!stroke.is_fitted() && stroke.points.size() < 2) return;
+    
+    cr->set_source_rgba(stroke.color.r, stroke.color.g, stroke.color.b, stroke.color.a);
+    
+    // Completed strokes fill their fitted Bezier outline in one go
+    if (stroke.is_fitted()) {
+        stroke.append_outline_path(cr);
+        cr->fill();
+        return;
+    }
     
     // Points now contain calculated smooth points directly
     // Set stroke properties with antialiasing
-    cr->set_source_rgba(stroke.color.r, stroke.color.g, stroke.color.b, stroke.color.a);
     cr->set_line_width(stroke.width);
     cr->set_line_cap(Cairo::Context::LineCap::ROUND);
     cr->set_line_join(Cairo::Context::LineJoin::ROUND);
     // Cairo automatically provides good antialiasing by default
     
-    // Start path at first point
-    cr->move_to(stroke.points[0].x, stroke.points[0].y);
-    
-    // Draw smooth lines connecting all interpolated points
-    for (size_t i = 1; i < stroke.points.size(); i++) {
-        cr->line_to(stroke.points[i].x, stroke.points[i].y);
-    }
+    // Draw smooth lines connecting the interpolated points, skipping segments outside the repainted area
+    double clip_x1, clip_y1, clip_x2, clip_y2;
+    cr->get_clip_extents(clip_x1, clip_y1, clip_x2, clip_y2);
+    stroke.append_centerline_path(cr, BoundingBox(clip_x1, clip_y1, clip_x2 - clip_x1, clip_y2 - clip_y1));
     
     // Stroke the path
     cr->stroke();
@@ -512,57 +792,44 @@ std::vector<Point> CairoDrawingArea::ultra_smooth_stroke(const std::vector<Point
     // Step 1: Light simplification to remove micro-jitter
     std::vector<Point> simplified = simplify_stroke(points, 0.5);
     
-    // Step 2: Heavy Catmull-Rom interpolation for ultra-smooth curves
-    std::vector<Point> ultra_smooth = interpolate_catmull_rom(simplified, 12);
+    // Step 2: Adaptive Catmull-Rom interpolation for ultra-smooth curves
+    std::vector<Point> ultra_smooth = interpolate_catmull_rom(simplified, flatness_tolerance());
     
     return ultra_smooth;
 }
 
-std::vector<Point> CairoDrawingArea::interpolate_catmull_rom(const std::vector<Point>& points, int segments_per_curve) {
+std::vector<Point> CairoDrawingArea::interpolate_catmull_rom(const std::vector<Point>& points, double tolerance) {
     if (points.size() < 2) return points;
     if (points.size() == 2) return points;
     
-    std::vector<Point> interpolated;
-    interpolated.reserve(points.size() * segments_per_curve);
-    
-    // Add first point
-    interpolated.push_back(points[0]);
-    
-    // Interpolate between each consecutive pair of points
+    // Build every segment first, then evaluate them all in one vectorized pass
+    std::vector<SplineSegment> segments;
+    segments.reserve(points.size() - 1);
     for (size_t i = 0; i < points.size() - 1; i++) {
         // Get the four control points for Catmull-Rom spline
-        Point p0 = (i > 0) ? points[i-1] : points[i];
-        Point p1 = points[i];
-        Point p2 = points[i+1];
-        Point p3 = (i+2 < points.size()) ? points[i+2] : points[i+1];
+        const Point& p0 = (i > 0) ? points[i-1] : points[i];
+        const Point& p1 = points[i];
+        const Point& p2 = points[i+1];
+        const Point& p3 = (i+2 < points.size()) ? points[i+2] : points[i+1];
         
-        // Generate many interpolated points for super smooth curves
-        for (int j = 1; j <= segments_per_curve; j++) {
-            double t = (double)j / segments_per_curve;
-            Point interpolated_point = catmull_rom_point(p0, p1, p2, p3, t);
-            interpolated.push_back(interpolated_point);
-        }
+        // Subdivide only as finely as the curvature needs
+        int segments_per_curve = catmull_rom_subdivisions(p0, p1, p2, p3, tolerance);
+        segments.push_back(make_catmull_rom_segment(p0, p1, p2, p3, segments_per_curve));
     }
     
-    return interpolated;
-}
-
-Point CairoDrawingArea::catmull_rom_point(const Point& p0, const Point& p1, const Point& p2, const Point& p3, double t) {
-    double t2 = t * t;
-    double t3 = t2 * t;
+    std::vector<double> xs, ys;
+    size_t count = evaluate_spline_segments(segments, xs, ys);
     
-    // Catmull-Rom spline formula
-    double x = 0.5 * ((2.0 * p1.x) +
-                     (-p0.x + p2.x) * t +
-                     (2.0 * p0.x - 5.0 * p1.x + 4.0 * p2.x - p3.x) * t2 +
-                     (-p0.x + 3.0 * p1.x - 3.0 * p2.x + p3.x) * t3);
+    std::vector<Point> interpolated;
+    interpolated.reserve(count + 1);
     
-    double y = 0.5 * ((2.0 * p1.y) +
-                     (-p0.y + p2.y) * t +
-                     (2.0 * p0.y - 5.0 * p1.y + 4.0 * p2.y - p3.y) * t2 +
-                     (-p0.y + 3.0 * p1.y - 3.0 * p2.y + p3.y) * t3);
+    // Add first point
+    interpolated.push_back(points[0]);
+    for (size_t i = 0; i < count; i++) {
+        interpolated.emplace_back(xs[i], ys[i]);
+    }
     
-    return Point(x, y);
+    return interpolated;
 }
 
 double CairoDrawingArea::point_distance(const Point& p1, const Point& p2) {
@@ -571,19 +838,122 @@ double CairoDrawingArea::point_distance(const Point& p1, const Point& p2) {
     return sqrt(dx * dx + dy * dy);
 }
 
+double CairoDrawingArea::flatness_tolerance() const {
+    // Tolerance is defined in device pixels; HiDPI outputs need finer tessellation
+    int scale = std::max(1, get_scale_factor());
+    return DEFAULT_FLATNESS_TOLERANCE / scale;
+}
+
+double CairoDrawingArea::fit_tolerance() const {
+    int scale = std::max(1, get_scale_factor());
+    return fit_tolerance_px / scale;
+}
+
 // Public interface methods
 void CairoDrawingArea::clear_canvas() {
-    completed_strokes.clear();
+    scene.clear();
+    selection.clear();
+    history.clear();
+    is_lifted = false;
+    lifted_surface.reset();
+    is_resizing = false;
+    resizing.clear();
+    resize_start_transforms.clear();
+    resize_start_weights.clear();
+    resize_previews.clear();
+    resize_preview_transforms.clear();
+    rebuild_background_surface();
     current_stroke = Stroke(current_pen_width, current_pen_color);
     is_drawing = false;
     queue_draw();
 }
 
 void CairoDrawingArea::undo() {
-    if (!completed_strokes.empty()) {
-        completed_strokes.pop_back();
-        queue_draw();
+    history.undo([this](SceneEdit& edit) { apply_edit(edit, false); });
+}
+
+void CairoDrawingArea::redo() {
+    history.redo([this](SceneEdit& edit) { apply_edit(edit, true); });
+}
+
+void CairoDrawingArea::set_undo_budget(size_t bytes) {
+    history.set_budget(bytes);
+}
+
+void CairoDrawingArea::set_undo_window(size_t bytes) {
+    history.set_window(bytes);
+}
+
+void CairoDrawingArea::apply_edit(SceneEdit& edit, bool forward) {
+    damage_area(selection_bounds());  // Handles
+    switch (edit.type) {
+        case SceneEdit::Type::ADD:
+        case SceneEdit::Type::ERASE: {
+            // Same swap both ways: what is in goes to the stash, what was stashed comes back
+            for (ObjectId id : edit.ids) {
+                if (scene.contains(id)) invalidate_background(scene.bounds(id));
+            }
+            std::vector<SceneObject> taken = scene.extract(edit.ids);
+            edit.ids = scene.restore(std::move(edit.stash));
+            edit.stash = std::move(taken);
+            for (ObjectId id : edit.ids) invalidate_background(scene.bounds(id));
+            break;
+        }
+        case SceneEdit::Type::MOVE: {
+            double sign = forward ? 1.0 : -1.0;
+            for (ObjectId id : edit.ids) {
+                if (!scene.contains(id)) continue;
+                invalidate_background(scene.bounds(id));
+                scene.translate(id, sign * edit.dx, sign * edit.dy);
+                scene.bake(id);
+                invalidate_background(scene.bounds(id));
+            }
+            break;
+        }
+        case SceneEdit::Type::RESIZE: {
+            double scale_x = forward ? edit.scale_x : 1.0 / edit.scale_x;
+            double scale_y = forward ? edit.scale_y : 1.0 / edit.scale_y;
+            for (size_t i = 0; i < edit.ids.size(); i++) {
+                ObjectId id = edit.ids[i];
+                if (!scene.contains(id)) continue;
+                invalidate_background(scene.bounds(id));
+                scene.scale(id, scale_x, scale_y, edit.origin_x, edit.origin_y);
+                scene.bake(id);
+                // Weights are swapped in, not rescaled; the edit keeps the other side
+                double weight = scene.weight(id);
+                scene.set_weight(id, edit.weights[i]);
+                edit.weights[i] = weight;
+                invalidate_background(scene.bounds(id));
+            }
+            break;
+        }
+    }
+    
+    // IDs are stable, so only objects the edit took out leave the selection
+    selection.remove_if([this](ObjectId id) { return !scene.contains(id); });
+    damage_area(selection_bounds());
+    queue_damage();
+}
+
+void CairoDrawingArea::record_transform() {
+    // However many motion events the drag took, it undoes as one step
+    if ((is_moving || is_moving_selection) && (moved_dx != 0.0 || moved_dy != 0.0)) {
+        SceneEdit edit{SceneEdit::Type::MOVE, selection.ids()};
+        edit.dx = moved_dx;
+        edit.dy = moved_dy;
+        history.record(std::move(edit));
+    }
+    if (is_resizing && (resized_x != 1.0 || resized_y != 1.0)) {
+        SceneEdit edit{SceneEdit::Type::RESIZE, resizing};
+        edit.weights = resize_start_weights;
+        edit.scale_x = resized_x;
+        edit.scale_y = resized_y;
+        edit.origin_x = resize_origin_x;
+        edit.origin_y = resize_origin_y;
+        history.record(std::move(edit));
     }
+    moved_dx = moved_dy = 0.0;
+    resized_x = resized_y = 1.0;
 }
 
 void CairoDrawingArea::set_stroke_width(double width) {
@@ -591,6 +961,22 @@ void CairoDrawingArea::set_stroke_width(double width) {
     current_stroke.width = width;
 }
 
+void CairoDrawingArea::set_eraser_radius(double radius) {
+    current_eraser.set_radius(radius);
+}
+
+void CairoDrawingArea::set_eraser_partial(bool enabled) {
+    current_eraser.set_partial(enabled);
+}
+
+void CairoDrawingArea::set_lasso_policy(LassoPolicy policy) {
+    lasso_policy = policy;
+}
+
+void CairoDrawingArea::set_fit_tolerance(double device_pixels) {
+    fit_tolerance_px = device_pixels;
+}
+
 void CairoDrawingArea::set_stroke_color(const Color& color) {
     current_pen_color = color;
     current_stroke.color = color;
@@ -606,9 +992,8 @@ void CairoDrawingArea::set_rectangle_color(const Color& color) {
 }
 
 void CairoDrawingArea::draw_erasing_preview(const Cairo::RefPtr<Cairo::Context>& cr, const Stroke& stroke) {
-    if (stroke.points.size() < 2) return;
+    if (!stroke.is_fitted() && stroke.points.size() < 2) return;
     
-    // Points now contain calculated smooth points directly
     // Draw stroke with 50% transparency to show it will be erased
     cr->set_source_rgba(stroke.color.r, stroke.color.g, stroke.color.b, 0.5);
     cr->set_line_width(stroke.width);
@@ -616,179 +1001,157 @@ void CairoDrawingArea::draw_erasing_preview(const Cairo::RefPtr<Cairo::Context>&
     cr->set_line_join(Cairo::Context::LineJoin::ROUND);
     
     // Draw the smooth stroke path
-    cr->move_to(stroke.points[0].x, stroke.points[0].y);
-    for (size_t i = 1; i < stroke.points.size(); i++) {
-        cr->line_to(stroke.points[i].x, stroke.points[i].y);
-    }
+    stroke.append_centerline_path(cr);
     cr->stroke();
 }
 
-bool CairoDrawingArea::is_stroke_in_eraser_radius(const Stroke& stroke, double eraser_x, double eraser_y, double radius) {
-    // Points now contain calculated smooth points directly
-    // Check if any point in the smooth stroke is within the eraser radius
-    for (const auto& point : stroke.points) {
-        double distance = point_distance(Point(eraser_x, eraser_y), point);
-        if (distance <= radius) {
-            return true;
-        }
-    }
-    return false;
+bool CairoDrawingArea::is_stroke_in_eraser_radius(const Stroke& stroke, const Point& from, const Point& to, double radius) {
+    // Check if any inked part of the stroke is within the swept eraser
+    return stroke.intersects_capsule(from, to, radius);
 }
 
-bool CairoDrawingArea::is_rect_in_eraser_radius(const Rect& rect, double eraser_x, double eraser_y, double radius) {
-    // Check if eraser circle intersects with rectangle
-    // Find closest point on rectangle to eraser center
-    double closest_x = std::max(rect.x, std::min(eraser_x, rect.x + rect.width));
-    double closest_y = std::max(rect.y, std::min(eraser_y, rect.y + rect.height));
-    
-    double distance = point_distance(Point(eraser_x, eraser_y), Point(closest_x, closest_y));
-    return distance <= radius;
+bool CairoDrawingArea::is_rect_in_eraser_radius(const Rect& rect, const Point& from, const Point& to, double radius) {
+    // Check if the swept eraser reaches the rectangle (dragged rectangles can have negative sizes)
+    BoundingBox box(std::min(rect.x, rect.x + rect.width), std::min(rect.y, rect.y + rect.height),
+                    std::abs(rect.width), std::abs(rect.height));
+    return segment_box_distance_squared(from, to, box) <= radius * radius;
 }
 
-bool CairoDrawingArea::is_circle_in_eraser_radius(const Circle_Data& circle, double eraser_x, double eraser_y, double radius) {
-    // Check if eraser circle intersects with the drawn circle
-    // Calculate distance between eraser center and circle center
-    double distance = point_distance(Point(eraser_x, eraser_y), Point(circle.x, circle.y));
-    
-    // Circles intersect if distance between centers is less than sum of radii
-    return distance <= (radius + circle.r);
+bool CairoDrawingArea::is_circle_in_eraser_radius(const Circle_Data& circle, const Point& from, const Point& to, double radius) {
+    // Circles intersect if the eraser path passes closer to the center than the sum of radii
+    double reach = radius + circle.r;
+    return point_segment_distance_squared(Point(circle.x, circle.y), from, to) <= reach * reach;
+}
+
+void Eraser::stage(ObjectId id) {
+    if (id >= tombstones.size()) tombstones.resize(id + 1, false);
+    if (tombstones[id]) return;
+    tombstones[id] = true;
+    erased.push_back(id);
+}
+
+void Eraser::clear() {
+    erased.clear();
+    tombstones.clear();
+    first_new_id = 0;
+    pieces.clear();
+    has_pending_invalidation = false;
+}
+
+void Eraser::invalidate_later(const BoundingBox& area) {
+    pending_invalidation = has_pending_invalidation ? merge_bounds(pending_invalidation, area) : area;
+    has_pending_invalidation = true;
 }
 
-void CairoDrawingArea::update_eraser_collision(double x, double y) {
-    const double eraser_radius = 10.0; // Default eraser radius
+void CairoDrawingArea::update_eraser_collision(const Point& from, const Point& to) {
+    const double eraser_radius = current_eraser.get_radius();
+    const BoundingBox swept = capsule_bounds(from, to, eraser_radius);
     
-    // Move strokes from main vector to preview vector on collision
-    for (auto it = completed_strokes.begin(); it != completed_strokes.end();) {
-        if (is_stroke_in_eraser_radius(*it, x, y, eraser_radius)) {
-            // Check if this stroke is already in the preview vector
-            bool already_in_preview = false;
-            for (const auto& preview_stroke : current_eraser.stroke_to_erase) {
-                if (&(*it) == &preview_stroke) {
-                    already_in_preview = true;
-                    break;
-                }
-            }
-            
-            if (!already_in_preview) {
-                // Move stroke to preview vector
-                current_eraser.stroke_to_erase.push_back(*it);
-                // Remove from main vector
-                it = completed_strokes.erase(it);
-                // IMPORTANT: Rebuild background surface after removing stroke
-                rebuild_background_surface();
-            } else {
-                ++it;
-            }
-        } else {
-            ++it;
+    // Hits are only staged: the object stays in the scene as a tombstone and
+    // leaves the index so later events don't test it again. The tiles under
+    // it are invalidated with the rest of the frame's hits in one go.
+    if (current_eraser.is_partial()) split_strokes_in_eraser(from, to);
+    
+    for (ObjectId id : scene.query_rect(swept)) {
+        // Objects with a pending transform are tested in their own space
+        Point a = from, b = to;
+        double radius = eraser_radius;
+        const Affine& m = scene.transform(id);
+        if (!m.is_identity()) {
+            Affine inverse = m.inverse();
+            a = inverse.apply(from);
+            b = inverse.apply(to);
+            radius /= m.mean_scale();
+        }
+        
+        bool hit = false;
+        switch (scene.kind(id)) {
+            case ObjectKind::STROKE:
+                if (current_eraser.is_partial()) continue;  // Already cut above
+                hit = is_stroke_in_eraser_radius(scene.stroke(id), a, b, radius);
+                break;
+            case ObjectKind::RECTANGLE:
+                hit = is_rect_in_eraser_radius(scene.rect(id), a, b, radius);
+                break;
+            case ObjectKind::CIRCLE:
+                hit = is_circle_in_eraser_radius(scene.circle(id), a, b, radius);
+                break;
         }
+        if (!hit) continue;
+        
+        BoundingBox bounds = scene.bounds(id);
+        damage_area(bounds);
+        current_eraser.invalidate_later(bounds);
+        current_eraser.stage(id);
+        scene.unindex(id);
     }
+}
+
+void CairoDrawingArea::split_strokes_in_eraser(const Point& from, const Point& to) {
+    const double eraser_radius = current_eraser.get_radius();
     
-    // Move rectangles from main vector to preview vector on collision
-    for (auto rect_it = completed_rectangles.begin(); rect_it != completed_rectangles.end();) {
-        bool rectangle_moved = false;
+    // Only strokes the index finds near the swept capsule are cut, and within
+    // those only the segments whose control box is in reach get sampled
+    for (ObjectId id : scene.query_rect(capsule_bounds(from, to, eraser_radius))) {
+        if (scene.kind(id) != ObjectKind::STROKE) continue;
+        if (!scene.transform(id).is_identity() && !scene.bake(id)) continue;  // Pieces are cut from plain geometry
+        std::vector<Stroke> pieces;
+        if (!scene.stroke(id).erase_capsule(from, to, eraser_radius, pieces)) continue;
         
-        // Check each rect in the rectangle
-        for (auto& rect : rect_it->rects) {
-            if (is_rect_in_eraser_radius(rect, x, y, eraser_radius)) {
-                // Check if this rectangle is already in preview
-                bool already_in_preview = false;
-                for (const auto& preview_rect : current_eraser.rectangle_to_erase) {
-                    if (&rect == &preview_rect) {
-                        already_in_preview = true;
-                        break;
-                    }
-                }
-                
-                if (!already_in_preview) {
-                    // Move all rects from this rectangle to preview
-                    for (const auto& r : rect_it->rects) {
-                        current_eraser.rectangle_to_erase.push_back(r);
-                    }
-                    // Remove from main vector
-                    rect_it = completed_rectangles.erase(rect_it);
-                    rectangle_moved = true;
-                    // IMPORTANT: Rebuild background surface after removing rectangle
-                    rebuild_background_surface();
-                }
-                break; // Break inner loop since we processed the whole rectangle
-            }
-        }
+        // The stroke becomes a tombstone and its pieces go right above it,
+        // so they keep its place in the drawing order
+        BoundingBox bounds = scene.bounds(id);
+        damage_area(bounds);
+        current_eraser.invalidate_later(bounds);
+        current_eraser.stage(id);
+        scene.unindex(id);
         
-        if (!rectangle_moved) {
-            ++rect_it; // Only increment if we didn't move
+        ObjectId below = id;
+        for (auto& piece : pieces) {
+            below = scene.add_stroke_above(below, std::move(piece));
+            current_eraser.pieces.push_back(below);
         }
     }
+}
+
+void CairoDrawingArea::flush_eraser_invalidation() {
+    if (!current_eraser.has_pending_invalidation) return;
     
-    // Move circles from main vector to preview vector on collision
-    for (auto circle_it = completed_circles.begin(); circle_it != completed_circles.end();) {
-        bool circle_moved = false;
-        
-        // Check each circle in the Circle object
-        for (auto& circle : circle_it->circles) {
-            if (is_circle_in_eraser_radius(circle, x, y, eraser_radius)) {
-                // Check if this circle is already in preview
-                bool already_in_preview = false;
-                for (const auto& preview_circle : current_eraser.circle_to_erase) {
-                    if (&circle == &preview_circle) {
-                        already_in_preview = true;
-                        break;
-                    }
-                }
-                
-                if (!already_in_preview) {
-                    // Move all circles from this Circle object to preview
-                    for (const auto& c : circle_it->circles) {
-                        current_eraser.circle_to_erase.push_back(c);
-                    }
-                    // Remove from main vector
-                    circle_it = completed_circles.erase(circle_it);
-                    circle_moved = true;
-                    // IMPORTANT: Rebuild background surface after removing circle
-                    rebuild_background_surface();
-                }
-                break; // Break inner loop since we processed the whole Circle object
-            }
-        }
-        
-        if (!circle_moved) {
-            ++circle_it; // Only increment if we didn't move
-        }
-    }
+    const BoundingBox& area = current_eraser.pending_invalidation;
+    background_tiles.invalidate(area.x, area.y, area.width, area.height);
+    current_eraser.has_pending_invalidation = false;
 }
 
-void CairoDrawingArea::update_eraser_preview(double x, double y) {
-    const double eraser_radius = 20.0; // Default eraser radius
+void CairoDrawingArea::finish_erasing() {
+    flush_eraser_invalidation();
     
-    // Clear previous preview selections
-    current_eraser.stroke_to_erase.clear();
-    current_eraser.rectangle_to_erase.clear();
-    current_eraser.circle_to_erase.clear();
+    // The background already leaves the tombstones out; only the dimmed overlay goes away
+    for (ObjectId id : current_eraser.erased) damage_area(scene.bounds(id));
     
-    // Check collision with strokes for preview (don't erase yet)
-    for (const auto& stroke : completed_strokes) {
-        if (is_stroke_in_eraser_radius(stroke, x, y, eraser_radius)) {
-            current_eraser.stroke_to_erase.push_back(stroke);
+    // Objects that were there before the gesture, for undo, at the depth they
+    // get back once the surviving pieces are gone again (pieces that were
+    // erased again are gone for good)
+    SceneEdit edit{SceneEdit::Type::ERASE};
+    size_t depth = 0;
+    for (ObjectId id : scene.z_order()) {
+        if (id >= current_eraser.first_new_id) continue;
+        if (current_eraser.is_erased(id)) {
+            SceneObject removed = scene.copy(id);
+            removed.depth = depth;
+            edit.stash.push_back(std::move(removed));
         }
+        depth++;
     }
-    
-    // Check collision with rectangles for preview (don't erase yet)
-    for (const auto& rectangle : completed_rectangles) {
-        for (const auto& rect : rectangle.rects) {
-            if (is_rect_in_eraser_radius(rect, x, y, eraser_radius)) {
-                current_eraser.rectangle_to_erase.push_back(rect);
-            }
-        }
+    for (ObjectId id : current_eraser.pieces) {
+        if (!current_eraser.is_erased(id)) edit.ids.push_back(id);
     }
     
-    // Check collision with circles for preview (don't erase yet)
-    for (const auto& circle : completed_circles) {
-        for (const auto& c : circle.circles) {
-            if (is_circle_in_eraser_radius(c, x, y, eraser_radius)) {
-                current_eraser.circle_to_erase.push_back(c);
-            }
-        }
-    }
+    scene.remove(current_eraser.erased);
+    for (ObjectId id : current_eraser.erased) selection.remove(id);
+    
+    // The whole gesture undoes as one step
+    if (!edit.ids.empty() || !edit.stash.empty()) history.record(std::move(edit));
+    current_eraser.clear();
 }
 
 void CairoDrawingArea::set_drawing_state(std::string state){
@@ -816,306 +1179,341 @@ void CairoDrawingArea::set_current_cursor() {
 
 void CairoDrawingArea::clear_selection() {
     clear_all_selections();
-    queue_draw();
+    queue_full_draw();
 }
 
-// ===== UNIFIED OBJECT SYSTEM IMPLEMENTATIONS =====
-
-// DrawableObject base class methods
-HandlePosition DrawableObject::get_handle_at_point(double x, double y) const {
-    BoundingBox bbox = get_bounding_box();
-    const double handle_size = 8.0;
-    const double half_handle = handle_size / 2.0;
-    
-    // Check corner handles first
-    if (std::abs(x - bbox.x) <= half_handle && std::abs(y - bbox.y) <= half_handle)
-        return HandlePosition::TOP_LEFT;
-    if (std::abs(x - (bbox.x + bbox.width)) <= half_handle && std::abs(y - bbox.y) <= half_handle)
-        return HandlePosition::TOP_RIGHT;
-    if (std::abs(x - bbox.x) <= half_handle && std::abs(y - (bbox.y + bbox.height)) <= half_handle)
-        return HandlePosition::BOTTOM_LEFT;
-    if (std::abs(x - (bbox.x + bbox.width)) <= half_handle && std::abs(y - (bbox.y + bbox.height)) <= half_handle)
-        return HandlePosition::BOTTOM_RIGHT;
-    
-    // Check edge handles
-    double mid_x = bbox.x + bbox.width / 2.0;
-    double mid_y = bbox.y + bbox.height / 2.0;
-    
-    if (std::abs(x - mid_x) <= half_handle && std::abs(y - bbox.y) <= half_handle)
-        return HandlePosition::TOP;
-    if (std::abs(x - mid_x) <= half_handle && std::abs(y - (bbox.y + bbox.height)) <= half_handle)
-        return HandlePosition::BOTTOM;
-    if (std::abs(x - bbox.x) <= half_handle && std::abs(y - mid_y) <= half_handle)
-        return HandlePosition::LEFT;
-    if (std::abs(x - (bbox.x + bbox.width)) <= half_handle && std::abs(y - mid_y) <= half_handle)
-        return HandlePosition::RIGHT;
-    
-    return HandlePosition::NONE;
+void CairoDrawingArea::select_all() {
+    selection.select_all(scene.z_order());
+    queue_full_draw(); // Highlights can be anywhere
 }
 
-void DrawableObject::draw_selection_handles(const Cairo::RefPtr<Cairo::Context>& cr) const {
-    if (!is_selected) return;
-    
-    BoundingBox bbox = get_bounding_box();
-    const double handle_size = 8.0;
-    const double half_handle = handle_size / 2.0;
-    
-    cr->set_source_rgb(0.2, 0.6, 1.0); // Blue handles
-    cr->set_line_width(1.0);
-    
-    // Draw corner handles
-    std::vector<std::pair<double, double>> handle_positions = {
-        {bbox.x, bbox.y}, // TOP_LEFT
-        {bbox.x + bbox.width, bbox.y}, // TOP_RIGHT
-        {bbox.x, bbox.y + bbox.height}, // BOTTOM_LEFT
-        {bbox.x + bbox.width, bbox.y + bbox.height}, // BOTTOM_RIGHT
-        {bbox.x + bbox.width/2, bbox.y}, // TOP
-        {bbox.x + bbox.width/2, bbox.y + bbox.height}, // BOTTOM
-        {bbox.x, bbox.y + bbox.height/2}, // LEFT
-        {bbox.x + bbox.width, bbox.y + bbox.height/2} // RIGHT
-    };
-    
-    for (const auto& pos : handle_positions) {
-        cr->rectangle(pos.first - half_handle, pos.second - half_handle, handle_size, handle_size);
-        cr->fill_preserve();
-        cr->set_source_rgb(0.0, 0.0, 0.0);
-        cr->stroke();
-        cr->set_source_rgb(0.2, 0.6, 1.0);
-    }
+void CairoDrawingArea::invert_selection() {
+    selection.invert(scene.z_order());
+    queue_full_draw();
 }
 
-// StrokeObject implementation
-void StrokeObject::draw(const Cairo::RefPtr<Cairo::Context>& cr) const {
-    if (stroke.points.size() < 2) return;
-    
-    cr->set_source_rgba(stroke.color.r, stroke.color.g, stroke.color.b, stroke.color.a);
-    cr->set_line_width(stroke.width);
-    cr->set_line_cap(Cairo::Context::LineCap::ROUND);
-    cr->set_line_join(Cairo::Context::LineJoin::ROUND);
-    
-    cr->move_to(stroke.points[0].x, stroke.points[0].y);
-    for (size_t i = 1; i < stroke.points.size(); i++) {
-        cr->line_to(stroke.points[i].x, stroke.points[i].y);
-    }
-    cr->stroke();
-}
+// ===== SCENE STORE =====
 
-BoundingBox StrokeObject::get_bounding_box() const {
-    if (stroke.points.empty()) return BoundingBox();
-    
-    double min_x = stroke.points[0].x, max_x = stroke.points[0].x;
-    double min_y = stroke.points[0].y, max_y = stroke.points[0].y;
-    
-    for (const auto& point : stroke.points) {
-        min_x = std::min(min_x, point.x);
-        max_x = std::max(max_x, point.x);
-        min_y = std::min(min_y, point.y);
-        max_y = std::max(max_y, point.y);
-    }
-    
-    // Add stroke width padding
-    double padding = stroke.width / 2.0;
-    return BoundingBox(min_x - padding, min_y - padding, 
-                      max_x - min_x + 2*padding, max_y - min_y + 2*padding);
+ObjectId SceneStore::new_id(ObjectKind kind, uint32_t slot) {
+    Slot entry;
+    entry.kind = kind;
+    entry.slot = slot;
+    entry.live = true;
+    slots.push_back(entry);
+    transforms.push_back(Affine());
+    return (ObjectId)(slots.size() - 1);
 }
 
-bool StrokeObject::hit_test(double x, double y) const {
-    const double tolerance = stroke.width / 2.0 + 2.0;
-    
-    for (const auto& point : stroke.points) {
-        double distance = sqrt((x - point.x)*(x - point.x) + (y - point.y)*(y - point.y));
-        if (distance <= tolerance) return true;
-    }
-    return false;
+void SceneStore::place(ObjectId id, size_t depth) {
+    depth = std::min(depth, order.size());
+    order.insert(order.begin() + depth, id);
+    renumber(depth);
+    index.insert(id, bounds(id));
 }
 
-void StrokeObject::translate(double dx, double dy) {
-    for (auto& point : stroke.points) {
-        point.x += dx;
-        point.y += dy;
-    }
+void SceneStore::renumber(size_t first_depth) {
+    for (size_t i = first_depth; i < order.size(); i++) slots[order[i]].depth = (uint32_t)i;
 }
 
-void StrokeObject::scale(double scale_x, double scale_y, double origin_x, double origin_y) {
-    for (auto& point : stroke.points) {
-        point.x = origin_x + (point.x - origin_x) * scale_x;
-        point.y = origin_y + (point.y - origin_y) * scale_y;
-    }
-    stroke.width *= std::min(scale_x, scale_y); // Scale line width proportionally
-}
-
-// RectangleObject implementation
-void RectangleObject::draw(const Cairo::RefPtr<Cairo::Context>& cr) const {
-    cr->set_source_rgb(rect.color.r, rect.color.g, rect.color.b);
-    cr->set_line_width(2.0);
-    cr->rectangle(rect.x, rect.y, rect.width, rect.height);
-    cr->stroke();
+ObjectId SceneStore::add_stroke(Stroke stroke) {
+    return add_stroke_above(order.empty() ? NO_OBJECT : order.back(), std::move(stroke));
 }
 
-BoundingBox RectangleObject::get_bounding_box() const {
-    return BoundingBox(rect.x, rect.y, rect.width, rect.height);
+ObjectId SceneStore::add_stroke_above(ObjectId below, Stroke stroke) {
+    strokes.push_back(std::move(stroke));
+    ObjectId id = new_id(ObjectKind::STROKE, (uint32_t)(strokes.size() - 1));
+    stroke_ids.push_back(id);
+    place(id, below == NO_OBJECT ? 0 : slots[below].depth + 1);
+    return id;
 }
 
-bool RectangleObject::hit_test(double x, double y) const {
-    return x >= rect.x && x <= rect.x + rect.width && 
-           y >= rect.y && y <= rect.y + rect.height;
+ObjectId SceneStore::add_rectangle(const Rect& rect) {
+    rects.push_back(rect);
+    ObjectId id = new_id(ObjectKind::RECTANGLE, (uint32_t)(rects.size() - 1));
+    rect_ids.push_back(id);
+    place(id, order.size());
+    return id;
 }
 
-void RectangleObject::translate(double dx, double dy) {
-    rect.x += dx;
-    rect.y += dy;
+ObjectId SceneStore::add_circle(const Circle_Data& circle) {
+    circles.push_back(circle);
+    ObjectId id = new_id(ObjectKind::CIRCLE, (uint32_t)(circles.size() - 1));
+    circle_ids.push_back(id);
+    place(id, order.size());
+    return id;
 }
 
-void RectangleObject::scale(double scale_x, double scale_y, double origin_x, double origin_y) {
-    rect.x = origin_x + (rect.x - origin_x) * scale_x;
-    rect.y = origin_y + (rect.y - origin_y) * scale_y;
-    rect.width *= scale_x;
-    rect.height *= scale_y;
+SceneObject SceneStore::copy(ObjectId id) const {
+    SceneObject object{id, depth(id), Stroke()};
+    switch (kind(id)) {
+        case ObjectKind::STROKE:
+            object.shape = stroke(id);
+            std::get<Stroke>(object.shape).release_paths();
+            break;
+        case ObjectKind::RECTANGLE: object.shape = rect(id); break;
+        case ObjectKind::CIRCLE: object.shape = circle(id); break;
+    }
+    object.transform = transforms[id];
+    return object;
 }
 
-// CircleObject implementation
-void CircleObject::draw(const Cairo::RefPtr<Cairo::Context>& cr) const {
-    cr->set_source_rgb(circle.color.r, circle.color.g, circle.color.b);
-    cr->set_line_width(2.0);
-    cr->arc(circle.x, circle.y, circle.r, 0, 2 * M_PI);
-    cr->stroke();
+std::vector<SceneObject> SceneStore::extract(const std::vector<ObjectId>& ids) {
+    std::vector<SceneObject> objects;
+    objects.reserve(ids.size());
+    for (ObjectId id : ids) {
+        if (contains(id)) objects.push_back(copy(id));
+    }
+    // Reinserting by ascending depth puts every object back where it was
+    std::sort(objects.begin(), objects.end(), [](const SceneObject& a, const SceneObject& b) { return a.depth < b.depth; });
+    remove(ids);
+    return objects;
 }
 
-BoundingBox CircleObject::get_bounding_box() const {
-    return BoundingBox(circle.x - circle.r, circle.y - circle.r, 
-                      2 * circle.r, 2 * circle.r);
+std::vector<ObjectId> SceneStore::restore(std::vector<SceneObject> objects) {
+    std::vector<ObjectId> ids;
+    ids.reserve(objects.size());
+    for (auto& object : objects) {
+        if (object.id >= slots.size() || slots[object.id].live) continue;
+        
+        Slot& entry = slots[object.id];
+        entry.kind = object.kind();
+        entry.live = true;
+        transforms[object.id] = object.transform;
+        switch (entry.kind) {
+            case ObjectKind::STROKE:
+                strokes.push_back(std::move(std::get<Stroke>(object.shape)));
+                stroke_ids.push_back(object.id);
+                entry.slot = (uint32_t)(strokes.size() - 1);
+                break;
+            case ObjectKind::RECTANGLE:
+                rects.push_back(std::get<Rect>(object.shape));
+                rect_ids.push_back(object.id);
+                entry.slot = (uint32_t)(rects.size() - 1);
+                break;
+            case ObjectKind::CIRCLE:
+                circles.push_back(std::get<Circle_Data>(object.shape));
+                circle_ids.push_back(object.id);
+                entry.slot = (uint32_t)(circles.size() - 1);
+                break;
+        }
+        place(object.id, object.depth);
+        ids.push_back(object.id);
+    }
+    return ids;
 }
 
-bool CircleObject::hit_test(double x, double y) const {
-    double distance = sqrt((x - circle.x)*(x - circle.x) + (y - circle.y)*(y - circle.y));
-    return distance <= circle.r;
+template <typename T>
+void SceneStore::swap_remove(std::vector<T>& items, std::vector<ObjectId>& ids, std::vector<Slot>& slots, uint32_t slot) {
+    // The last element fills the hole, so the array stays dense without shifting
+    if (slot + 1 != items.size()) {
+        items[slot] = std::move(items.back());
+        ids[slot] = ids.back();
+        slots[ids[slot]].slot = slot;
+    }
+    items.pop_back();
+    ids.pop_back();
 }
 
-void CircleObject::translate(double dx, double dy) {
-    circle.x += dx;
-    circle.y += dy;
+void SceneStore::remove(const std::vector<ObjectId>& ids) {
+    size_t first_depth = order.size();
+    for (ObjectId id : ids) {
+        if (!contains(id)) continue;
+        Slot& entry = slots[id];
+        switch (entry.kind) {
+            case ObjectKind::STROKE: swap_remove(strokes, stroke_ids, slots, entry.slot); break;
+            case ObjectKind::RECTANGLE: swap_remove(rects, rect_ids, slots, entry.slot); break;
+            case ObjectKind::CIRCLE: swap_remove(circles, circle_ids, slots, entry.slot); break;
+        }
+        entry.live = false;
+        index.remove(id);
+        first_depth = std::min<size_t>(first_depth, entry.depth);
+    }
+    if (first_depth == order.size()) return;
+    
+    // One compaction pass over the drawing order, from the lowest hole up
+    order.erase(std::remove_if(order.begin() + first_depth, order.end(),
+                               [this](ObjectId id) { return !slots[id].live; }), order.end());
+    renumber(first_depth);
 }
 
-void CircleObject::scale(double scale_x, double scale_y, double origin_x, double origin_y) {
-    circle.x = origin_x + (circle.x - origin_x) * scale_x;
-    circle.y = origin_y + (circle.y - origin_y) * scale_y;
-    circle.r *= std::min(scale_x, scale_y); // Keep circle round
+void SceneStore::clear() {
+    slots.clear();
+    transforms.clear();
+    strokes.clear();
+    rects.clear();
+    circles.clear();
+    stroke_ids.clear();
+    rect_ids.clear();
+    circle_ids.clear();
+    order.clear();
+    index.clear();
 }
 
-// SelectionManager implementation
-void SelectionManager::clear_selection() {
-    for (auto& obj : selected_objects) {
-        obj->is_selected = false;
+BoundingBox SceneStore::bounds(ObjectId id) const {
+    BoundingBox box;
+    switch (kind(id)) {
+        case ObjectKind::STROKE: box = stroke(id).get_bounds(); break;
+        case ObjectKind::RECTANGLE: box = rect_bounds(rect(id)); break;
+        case ObjectKind::CIRCLE: box = circle_bounds(circle(id)); break;
     }
-    selected_objects.clear();
+    const Affine& m = transforms[id];
+    return m.is_identity() ? box : m.apply(box);
 }
 
-void SelectionManager::add_to_selection(std::shared_ptr<DrawableObject> obj) {
-    if (!is_selected(obj)) {
-        selected_objects.push_back(obj);
-        obj->is_selected = true;
-    }
+void SceneStore::set_transform(ObjectId id, const Affine& transform) {
+    transforms[id] = transform;
+    if (index.contains(id)) index.update(id, bounds(id));
 }
 
-void SelectionManager::remove_from_selection(std::shared_ptr<DrawableObject> obj) {
-    auto it = std::find(selected_objects.begin(), selected_objects.end(), obj);
-    if (it != selected_objects.end()) {
-        (*it)->is_selected = false;
-        selected_objects.erase(it);
-    }
+void SceneStore::translate(ObjectId id, double dx, double dy) {
+    set_transform(id, transforms[id].then(Affine::translation(dx, dy)));
 }
 
-bool SelectionManager::is_selected(std::shared_ptr<DrawableObject> obj) const {
-    return std::find(selected_objects.begin(), selected_objects.end(), obj) != selected_objects.end();
+void SceneStore::scale(ObjectId id, double scale_x, double scale_y, double origin_x, double origin_y) {
+    set_transform(id, transforms[id].then(Affine::scaling(scale_x, scale_y, origin_x, origin_y)));
 }
 
-BoundingBox SelectionManager::get_selection_bounds() const {
-    if (selected_objects.empty()) return BoundingBox();
-    
-    BoundingBox first_bbox = selected_objects[0]->get_bounding_box();
-    double min_x = first_bbox.x, max_x = first_bbox.x + first_bbox.width;
-    double min_y = first_bbox.y, max_y = first_bbox.y + first_bbox.height;
+bool SceneStore::bake(ObjectId id) {
+    const Affine& m = transforms[id];
+    if (m.is_identity()) return true;
     
-    for (const auto& obj : selected_objects) {
-        BoundingBox bbox = obj->get_bounding_box();
-        min_x = std::min(min_x, bbox.x);
-        max_x = std::max(max_x, bbox.x + bbox.width);
-        min_y = std::min(min_y, bbox.y);
-        max_y = std::max(max_y, bbox.y + bbox.height);
+    uint32_t slot = slots[id].slot;
+    bool baked = false;
+    switch (kind(id)) {
+        case ObjectKind::STROKE: baked = bake_geometry(strokes[slot], m); break;
+        case ObjectKind::RECTANGLE: baked = bake_geometry(rects[slot], m); break;
+        case ObjectKind::CIRCLE: baked = bake_geometry(circles[slot], m); break;
     }
+    if (!baked) return false;
     
-    return BoundingBox(min_x, min_y, max_x - min_x, max_y - min_y);
+    transforms[id] = Affine();
+    if (index.contains(id)) index.update(id, bounds(id));
+    return true;
 }
 
-void SelectionManager::move_selection(double dx, double dy) {
-    for (auto& obj : selected_objects) {
-        obj->translate(dx, dy);
+double SceneStore::weight(ObjectId id) const {
+    switch (kind(id)) {
+        case ObjectKind::STROKE: return strokes[slots[id].slot].width;
+        case ObjectKind::CIRCLE: return circles[slots[id].slot].r;
+        default: return 0.0;
     }
 }
 
-void SelectionManager::scale_selection(double scale_x, double scale_y, double origin_x, double origin_y) {
-    for (auto& obj : selected_objects) {
-        obj->scale(scale_x, scale_y, origin_x, origin_y);
+void SceneStore::set_weight(ObjectId id, double weight) {
+    switch (kind(id)) {
+        case ObjectKind::STROKE: strokes[slots[id].slot].set_width(weight); break;
+        case ObjectKind::CIRCLE: circles[slots[id].slot].r = weight; break;
+        default: return;
     }
+    if (index.contains(id)) index.update(id, bounds(id));
+}
+
+std::vector<ObjectId> SceneStore::query_rect(const BoundingBox& area) const {
+    // The index reports by ID; callers want drawing order
+    std::vector<ObjectId> ids = index.query_rect(area);
+    std::sort(ids.begin(), ids.end(), [this](ObjectId a, ObjectId b) { return slots[a].depth < slots[b].depth; });
+    return ids;
+}
+
+std::vector<ObjectId> SceneStore::query_radius(double x, double y, double radius) const {
+    return query_rect(BoundingBox(x - radius, y - radius, 2 * radius, 2 * radius));
 }
 
 // CairoDrawingArea selection system methods
-std::shared_ptr<DrawableObject> CairoDrawingArea::find_object_at_point(double x, double y) {
-    // Iterate in reverse order to check top-most objects first
-    for (auto it = drawable_objects.rbegin(); it != drawable_objects.rend(); ++it) {
-        if ((*it)->hit_test(x, y)) {
-            return *it;
-        }
+ObjectId CairoDrawingArea::find_object_at_point(double x, double y) {
+    // Candidates come in drawing order: check top-most objects first
+    std::vector<ObjectId> candidates = scene.query_radius(x, y, OBJECT_HIT_SLOP);
+    for (auto it = candidates.rbegin(); it != candidates.rend(); ++it) {
+        double tolerance = scene.kind(*it) == ObjectKind::STROKE ? scene.stroke(*it).width / 2.0 + OBJECT_HIT_SLOP : 0.0;
+        if (hit_test_object(*it, x, y, tolerance)) return *it;
     }
-    return nullptr;
+    return NO_OBJECT;
 }
 
-HandlePosition CairoDrawingArea::find_handle_at_point(double x, double y) {
-    for (const auto& obj : drawable_objects) {
-        if (obj->is_selected) {
-            HandlePosition handle = obj->get_handle_at_point(x, y);
-            if (handle != HandlePosition::NONE) {
-                return handle;
-            }
-        }
-    }
+static HandlePosition handle_at_point(const BoundingBox& bbox, double x, double y) {
+    const double half_handle = SELECTION_HANDLE_SIZE / 2.0;
+    
+    // Check corner handles first
+    if (std::abs(x - bbox.x) <= half_handle && std::abs(y - bbox.y) <= half_handle)
+        return HandlePosition::TOP_LEFT;
+    if (std::abs(x - (bbox.x + bbox.width)) <= half_handle && std::abs(y - bbox.y) <= half_handle)
+        return HandlePosition::TOP_RIGHT;
+    if (std::abs(x - bbox.x) <= half_handle && std::abs(y - (bbox.y + bbox.height)) <= half_handle)
+        return HandlePosition::BOTTOM_LEFT;
+    if (std::abs(x - (bbox.x + bbox.width)) <= half_handle && std::abs(y - (bbox.y + bbox.height)) <= half_handle)
+        return HandlePosition::BOTTOM_RIGHT;
+    
+    // Check edge handles
+    double mid_x = bbox.x + bbox.width / 2.0;
+    double mid_y = bbox.y + bbox.height / 2.0;
+    
+    if (std::abs(x - mid_x) <= half_handle && std::abs(y - bbox.y) <= half_handle)
+        return HandlePosition::TOP;
+    if (std::abs(x - mid_x) <= half_handle && std::abs(y - (bbox.y + bbox.height)) <= half_handle)
+        return HandlePosition::BOTTOM;
+    if (std::abs(x - bbox.x) <= half_handle && std::abs(y - mid_y) <= half_handle)
+        return HandlePosition::LEFT;
+    if (std::abs(x - (bbox.x + bbox.width)) <= half_handle && std::abs(y - mid_y) <= half_handle)
+        return HandlePosition::RIGHT;
+    
     return HandlePosition::NONE;
 }
 
+HandlePosition CairoDrawingArea::find_handle_at_point(double x, double y) {
+    // Handles sit on the box around the whole selection
+    if (selection.empty()) return HandlePosition::NONE;
+    return handle_at_point(selection_bounds(), x, y);
+}
+
 void CairoDrawingArea::update_selection(double x, double y, bool multi_select) {
-    auto clicked_obj = find_object_at_point(x, y);
+    ObjectId clicked = find_object_at_point(x, y);
     
-    if (!multi_select && !clicked_obj) {
+    if (!multi_select && clicked == NO_OBJECT) {
         // Clear selection if clicking on empty space
-        selection_manager.clear_selection();
-    } else if (clicked_obj) {
+        clear_all_selections();
+    } else if (clicked != NO_OBJECT) {
         if (multi_select) {
             // Toggle selection for multi-select
-            if (selection_manager.is_selected(clicked_obj)) {
-                selection_manager.remove_from_selection(clicked_obj);
-            } else {
-                selection_manager.add_to_selection(clicked_obj);
-            }
+            selection.toggle(clicked);
         } else {
             // Single selection
-            selection_manager.clear_selection();
-            selection_manager.add_to_selection(clicked_obj);
+            selection.clear();
+            selection.add(clicked);
         }
     }
 }
 
 void CairoDrawingArea::start_move_operation(double x, double y) {
-    if (selection_manager.has_selection()) {
+    if (!selection.empty()) {
         is_moving = true;
         selection_start = Point(x, y);
+        moved_dx = moved_dy = 0.0;
     }
 }
 
 void CairoDrawingArea::start_resize_operation(double x, double y, HandlePosition handle) {
-    if (selection_manager.has_selection() && handle != HandlePosition::NONE) {
+    if (!selection.empty() && handle != HandlePosition::NONE) {
         is_resizing = true;
         current_handle = handle;
         selection_start = Point(x, y);
+        resized_x = resized_y = 1.0;
+        resize_start_bounds = selection_bounds();
+        
+        resizing.assign(selection.begin(), selection.end());
+        std::sort(resizing.begin(), resizing.end(), [this](ObjectId a, ObjectId b) { return scene.depth(a) < scene.depth(b); });
+        resize_start_transforms.clear();
+        resize_start_weights.clear();
+        resize_previews.assign(resizing.size(), Stroke());
+        resize_preview_transforms.assign(resizing.size(), Affine());
+        for (size_t i = 0; i < resizing.size(); i++) {
+            ObjectId id = resizing[i];
+            resize_start_transforms.push_back(scene.transform(id));
+            resize_start_weights.push_back(scene.weight(id));
+            // Shares the stroke's cached paths until the first rebake
+            if (scene.kind(id) == ObjectKind::STROKE) resize_previews[i] = scene.stroke(id);
+            // The tiles under the selection re-render once without it
+            invalidate_background(scene.bounds(id));
+        }
     }
 }
 
@@ -1124,14 +1522,17 @@ void CairoDrawingArea::perform_move(double x, double y) {
         double dx = x - selection_start.x;
         double dy = y - selection_start.y;
         
-        selection_manager.move_selection(dx, dy);
+        move_selected_objects(dx, dy);
         selection_start = Point(x, y);
     }
 }
 
 void CairoDrawingArea::perform_resize(double x, double y) {
     if (is_resizing && current_handle != HandlePosition::NONE) {
-        BoundingBox bounds = selection_manager.get_selection_bounds();
+        // Measured from the press against the box the drag started with, so
+        // each event sets the whole scale instead of compounding a step
+        const BoundingBox& bounds = resize_start_bounds;
+        if (bounds.width <= 0.0 || bounds.height <= 0.0) return;
         
         // Calculate scale factors based on handle position and mouse movement
         double scale_x = 1.0, scale_y = 1.0;
@@ -1188,28 +1589,97 @@ void CairoDrawingArea::perform_resize(double x, double y) {
         
         // Prevent negative scaling
         if (scale_x > 0.1 && scale_y > 0.1) {
-            selection_manager.scale_selection(scale_x, scale_y, origin_x, origin_y);
-            selection_start = Point(x, y);
+            // O(1) per object: only the transforms change until release
+            damage_area(selection_bounds());
+            Affine drag = Affine::scaling(scale_x, scale_y, origin_x, origin_y);
+            for (size_t i = 0; i < resizing.size(); i++) {
+                scene.set_transform(resizing[i], resize_start_transforms[i].then(drag));
+            }
+            update_resize_previews();
+            damage_area(selection_bounds());
+            
+            resized_x = scale_x;
+            resized_y = scale_y;
+            resize_origin_x = origin_x;
+            resize_origin_y = origin_y;
         }
     }
 }
 
-void CairoDrawingArea::add_drawable_object(std::shared_ptr<DrawableObject> obj) {
-    drawable_objects.push_back(obj);
+void CairoDrawingArea::finish_resize() {
+    // Bake once: the tiles re-render with the final geometry
+    for (ObjectId id : resizing) {
+        if (!scene.contains(id)) continue;
+        damage_area(scene.bounds(id));
+        scene.bake(id);
+        invalidate_background(scene.bounds(id));
+    }
+    record_transform();
+    resizing.clear();
+    resize_start_transforms.clear();
+    resize_start_weights.clear();
+    resize_previews.clear();
+    resize_preview_transforms.clear();
+    is_resizing = false;
+    current_handle = HandlePosition::NONE;
 }
 
-void CairoDrawingArea::remove_drawable_object(std::shared_ptr<DrawableObject> obj) {
-    auto it = std::find(drawable_objects.begin(), drawable_objects.end(), obj);
-    if (it != drawable_objects.end()) {
-        drawable_objects.erase(it);
+void CairoDrawingArea::update_resize_previews() {
+    for (size_t i = 0; i < resizing.size(); i++) {
+        ObjectId id = resizing[i];
+        if (!scene.contains(id) || scene.kind(id) != ObjectKind::STROKE) continue;
+        
+        // Only the width is off when drawn through the residual; the curve is exact
+        const Affine& m = scene.transform(id);
+        Affine residual = resize_preview_transforms[i].inverse().then(m);
+        if (residual.is_axis_aligned() && std::abs(residual.xx - 1.0) <= RESIZE_PREVIEW_STEP &&
+            std::abs(residual.yy - 1.0) <= RESIZE_PREVIEW_STEP) {
+            continue;
+        }
+        
+        if (m.is_axis_aligned()) {
+            resize_previews[i] = scene.stroke(id);
+            bake_geometry(resize_previews[i], m);
+            resize_preview_transforms[i] = m;
+        } else if (!resize_preview_transforms[i].is_identity()) {
+            // Can't be baked (rotation): the plain stroke goes through the whole matrix
+            resize_previews[i] = scene.stroke(id);
+            resize_preview_transforms[i] = Affine();
+        }
     }
 }
 
+void CairoDrawingArea::draw_resize_previews(const Cairo::RefPtr<Cairo::Context>& cr) {
+    for (size_t i = 0; i < resizing.size(); i++) {
+        ObjectId id = resizing[i];
+        if (!scene.contains(id)) continue;
+        if (scene.kind(id) != ObjectKind::STROKE) {
+            draw_object(cr, id);
+            continue;
+        }
+        
+        // The cached outline goes through the residual, so a frame costs no rebuild
+        cr->save();
+        cr->transform(cairo_matrix(resize_preview_transforms[i].inverse().then(scene.transform(id))));
+        draw_smooth_stroke(cr, resize_previews[i]);
+        cr->restore();
+    }
+}
+
+BoundingBox CairoDrawingArea::selection_bounds() const {
+    BoundingBox bounds;
+    bool any = false;
+    for (ObjectId id : selection) {
+        if (!scene.contains(id)) continue;
+        bounds = any ? merge_bounds(bounds, scene.bounds(id)) : scene.bounds(id);
+        any = true;
+    }
+    return bounds;
+}
+
 // Selection functions implementation
 void CairoDrawingArea::clear_all_selections() {
-    selected_stroke_indices.clear();
-    selected_rectangle_indices.clear();
-    selected_circle_indices.clear();
+    selection.clear();
 }
 
 void CairoDrawingArea::select_objects_in_rectangle(double x1, double y1, double x2, double y2) {
@@ -1219,93 +1689,139 @@ void CairoDrawingArea::select_objects_in_rectangle(double x1, double y1, double
     double min_y = std::min(y1, y2);
     double max_y = std::max(y1, y2);
     
-    // Select strokes that intersect with selection rectangle
-    for (int i = 0; i < completed_strokes.size(); i++) {
-        const auto& stroke = completed_strokes[i];
+    // Only objects whose box meets the marquee are tested point by point
+    BoundingBox area(min_x, min_y, max_x - min_x, max_y - min_y);
+    
+    for (ObjectId id : scene.query_rect(area)) {
         bool intersects = false;
         
-        for (const auto& point : stroke.points) {
-            if (point.x >= min_x && point.x <= max_x && point.y >= min_y && point.y <= max_y) {
-                intersects = true;
+        switch (scene.kind(id)) {
+            case ObjectKind::STROKE: {
+                // Test segments along the fitted curve rather than its off-curve control points,
+                // so a long segment crossing the marquee counts even with no vertex inside
+                const Stroke& stroke = scene.stroke(id);
+                StrokePoints centerline = stroke.is_fitted() ? flatten_bezier_path(stroke.curve, flatness_tolerance()) : stroke.points;
+                if (centerline.size() == 1) {
+                    intersects = area.contains_point(centerline[0].x, centerline[0].y);
+                }
+                for (size_t j = 1; j < centerline.size(); j++) {
+                    if (segment_intersects_box(centerline[j - 1], centerline[j], area)) {
+                        intersects = true;
+                        break;
+                    }
+                }
                 break;
             }
-        }
-        
-        if (intersects) {
-            selected_stroke_indices.push_back(i);
-        }
-    }
-    
-    // Select rectangles that intersect with selection rectangle
-    for (int i = 0; i < completed_rectangles.size(); i++) {
-        const auto& rectangle = completed_rectangles[i];
-        bool intersects = false;
-        
-        for (const auto& rect : rectangle.rects) {
-            if (!(rect.x + rect.width < min_x || rect.x > max_x || 
-                  rect.y + rect.height < min_y || rect.y > max_y)) {
-                intersects = true;
+            case ObjectKind::RECTANGLE: {
+                const Rect& rect = scene.rect(id);
+                intersects = !(rect.x + rect.width < min_x || rect.x > max_x || 
+                               rect.y + rect.height < min_y || rect.y > max_y);
+                break;
+            }
+            case ObjectKind::CIRCLE: {
+                const Circle_Data& c = scene.circle(id);
+                intersects = !(c.x + c.r < min_x || c.x - c.r > max_x || 
+                               c.y + c.r < min_y || c.y - c.r > max_y);
                 break;
             }
         }
         
         if (intersects) {
-            selected_rectangle_indices.push_back(i);
+            selection.add(id);
         }
     }
+}
+
+void CairoDrawingArea::select_objects_in_lasso() {
+    LassoPolygon lasso(lasso_points);
+    if (lasso.empty()) return;
     
-    // Select circles that intersect with selection rectangle
-    for (int i = 0; i < completed_circles.size(); i++) {
-        const auto& circle = completed_circles[i];
-        bool intersects = false;
+    // The index drops everything outside the lasso's box; of the rest, objects
+    // whose box the loop doesn't cut are settled without looking at their geometry
+    for (ObjectId id : scene.query_rect(lasso.get_bounds())) {
+        LassoCoverage coverage = lasso.classify_box(scene.bounds(id));
+        if (coverage == LassoCoverage::OUTSIDE) continue;
         
-        for (const auto& c : circle.circles) {
-            if (!(c.x + c.r < min_x || c.x - c.r > max_x || 
-                  c.y + c.r < min_y || c.y - c.r > max_y)) {
-                intersects = true;
-                break;
+        bool selected = true;
+        if (coverage == LassoCoverage::PARTIAL) {
+            switch (scene.kind(id)) {
+                case ObjectKind::STROKE: {
+                    const Stroke& stroke = scene.stroke(id);
+                    StrokePoints centerline = stroke.is_fitted() ? flatten_bezier_path(stroke.curve, flatness_tolerance()) : stroke.points;
+                    selected = polyline_in_lasso(lasso, centerline, false, lasso_policy);
+                    break;
+                }
+                case ObjectKind::RECTANGLE:
+                    selected = polyline_in_lasso(lasso, rect_outline(scene.rect(id)), true, lasso_policy);
+                    break;
+                case ObjectKind::CIRCLE:
+                    selected = polyline_in_lasso(lasso, circle_outline(scene.circle(id)), true, lasso_policy);
+                    break;
             }
         }
-        
-        if (intersects) {
-            selected_circle_indices.push_back(i);
-        }
+        if (selected) selection.add(id);
     }
 }
 
-void CairoDrawingArea::move_selected_objects(double dx, double dy) {
-    // Move selected strokes
-    for (int idx : selected_stroke_indices) {
-        if (idx < completed_strokes.size()) {
-            for (auto& point : completed_strokes[idx].points) {
-                point.x += dx;
-                point.y += dy;
-            }
-        }
+bool CairoDrawingArea::is_point_on_selection(double x, double y) {
+    // Only objects the index finds near the pointer
+    for (ObjectId id : scene.query_radius(x, y, STROKE_GRAB_TOLERANCE)) {
+        if (!selection.contains(id)) continue;
+        if (hit_test_object(id, x, y, STROKE_GRAB_TOLERANCE)) return true;
     }
+    return false;
+}
+
+void CairoDrawingArea::move_selected_objects(double dx, double dy) {
+    if (selection.empty()) return;
+    if (!is_lifted) lift_selection();
+    
+    // Only the surface moves: repaint where it was and where it is now
+    damage_area(lifted_area());
+    moved_dx += dx;
+    moved_dy += dy;
+    damage_area(lifted_area());
+}
+
+void CairoDrawingArea::lift_selection() {
+    BoundingBox bounds = selection_bounds();
+    double x1 = std::floor(bounds.x - LIFT_MARGIN), y1 = std::floor(bounds.y - LIFT_MARGIN);
+    double x2 = std::ceil(bounds.x + bounds.width + LIFT_MARGIN), y2 = std::ceil(bounds.y + bounds.height + LIFT_MARGIN);
+    lifted_bounds = BoundingBox(x1, y1, x2 - x1, y2 - y1);
+    damage_area(lifted_bounds);  // Handles go while dragging
+    
+    // Drawn in drawing order once; while dragged the selection stays on top
+    std::vector<ObjectId> lifted(selection.begin(), selection.end());
+    std::sort(lifted.begin(), lifted.end(), [this](ObjectId a, ObjectId b) { return scene.depth(a) < scene.depth(b); });
+    
+    lifted_surface = create_layer_surface((int)(x2 - x1), (int)(y2 - y1), std::max(1, get_scale_factor()));
+    auto cr = Cairo::Context::create(lifted_surface);
+    cr->translate(-x1, -y1);
+    for (ObjectId id : lifted) draw_object(cr, id);
+    draw_selection_highlights(cr);
+    is_lifted = true;
     
-    // Move selected rectangles
-    for (int idx : selected_rectangle_indices) {
-        if (idx < completed_rectangles.size()) {
-            for (auto& rect : completed_rectangles[idx].rects) {
-                rect.x += dx;
-                rect.y += dy;
-            }
-        }
-    }
+    // The tiles under the selection re-render once without it
+    for (ObjectId id : lifted) invalidate_background(scene.bounds(id));
+}
+
+void CairoDrawingArea::drop_selection() {
+    if (!is_lifted) return;
+    is_lifted = false;
+    lifted_surface.reset();
+    damage_area(lifted_area());
     
-    // Move selected circles
-    for (int idx : selected_circle_indices) {
-        if (idx < completed_circles.size()) {
-            for (auto& circle : completed_circles[idx].circles) {
-                circle.x += dx;
-                circle.y += dy;
-            }
-        }
+    // Old positions were invalidated on lift; only the new ones need rendering
+    for (ObjectId id : selection) {
+        if (!scene.contains(id)) continue;
+        scene.translate(id, moved_dx, moved_dy);
+        scene.bake(id);
+        invalidate_background(scene.bounds(id));
     }
-    
-    // CRITICAL: Rebuild background surface after moving objects
-    rebuild_background_surface();
+}
+
+BoundingBox CairoDrawingArea::lifted_area() const {
+    return BoundingBox(lifted_bounds.x + moved_dx, lifted_bounds.y + moved_dy, lifted_bounds.width, lifted_bounds.height);
 }
 
 void CairoDrawingArea::draw_selection_rectangle(const Cairo::RefPtr<Cairo::Context>& cr, double x1, double y1, double x2, double y2) {
@@ -1318,59 +1834,98 @@ void CairoDrawingArea::draw_selection_rectangle(const Cairo::RefPtr<Cairo::Conte
     cr->stroke();
 }
 
+void CairoDrawingArea::draw_lasso(const Cairo::RefPtr<Cairo::Context>& cr) {
+    if (lasso_points.size() < 2) return;
+    
+    cr->move_to(lasso_points[0].x, lasso_points[0].y);
+    for (size_t i = 1; i < lasso_points.size(); i++) cr->line_to(lasso_points[i].x, lasso_points[i].y);
+    cr->close_path();
+    
+    // Same look as the selection rectangle; even-odd matches the containment rule
+    cr->set_fill_rule(Cairo::Context::FillRule::EVEN_ODD);
+    cr->set_source_rgba(0.2, 0.4, 0.8, 0.3);
+    cr->fill_preserve();
+    cr->set_fill_rule(Cairo::Context::FillRule::WINDING);
+    
+    cr->set_source_rgba(0.2, 0.4, 0.8, 0.8);
+    cr->set_line_width(1.0);
+    cr->stroke();
+}
+
 void CairoDrawingArea::draw_selection_highlights(const Cairo::RefPtr<Cairo::Context>& cr) {
-    // Highlight selected strokes
-    for (int idx : selected_stroke_indices) {
-        if (idx < completed_strokes.size()) {
-            const auto& stroke = completed_strokes[idx];
-            cr->set_source_rgba(0.8, 0.4, 0.2, 0.6); // Orange highlight
-            cr->set_line_width(stroke.width + 4.0);
-            cr->set_line_cap(Cairo::Context::LineCap::ROUND);
-            cr->set_line_join(Cairo::Context::LineJoin::ROUND);
-            
-            if (stroke.points.size() >= 2) {
-                cr->move_to(stroke.points[0].x, stroke.points[0].y);
-                for (size_t i = 1; i < stroke.points.size(); i++) {
-                    cr->line_to(stroke.points[i].x, stroke.points[i].y);
-                }
+    for (ObjectId id : selection) {
+        if (!scene.contains(id)) continue;
+        
+        // Paths follow a pending transform; the stroke width scales the way baking will
+        const Affine& m = scene.transform(id);
+        bool transformed = !m.is_identity();
+        switch (scene.kind(id)) {
+            case ObjectKind::STROKE: {
+                const Stroke& stroke = scene.stroke(id);
+                cr->set_source_rgba(0.8, 0.4, 0.2, 0.6); // Orange highlight
+                double width_scale = !transformed ? 1.0 : m.is_axis_aligned() ? std::min(m.xx, m.yy) : m.mean_scale();
+                cr->set_line_width(stroke.width * width_scale + 4.0);
+                cr->set_line_cap(Cairo::Context::LineCap::ROUND);
+                cr->set_line_join(Cairo::Context::LineJoin::ROUND);
+                
+                cr->save();
+                if (transformed) cr->transform(cairo_matrix(m));
+                stroke.append_centerline_path(cr);
+                cr->restore();
                 cr->stroke();
+                break;
             }
-        }
-    }
-    
-    // Highlight selected rectangles
-    for (int idx : selected_rectangle_indices) {
-        if (idx < completed_rectangles.size()) {
-            for (const auto& rect : completed_rectangles[idx].rects) {
+            case ObjectKind::RECTANGLE: {
+                Rect rect = scene.rect(id);
+                bool baked = !transformed || bake_geometry(rect, m);
                 cr->set_source_rgba(0.8, 0.4, 0.2, 0.4); // Orange highlight
                 cr->set_line_width(4.0);
+                cr->save();
+                if (!baked) cr->transform(cairo_matrix(m));
                 cr->rectangle(rect.x - 2, rect.y - 2, rect.width + 4, rect.height + 4);
+                cr->restore();
                 cr->stroke();
+                break;
             }
-        }
-    }
-    
-    // Highlight selected circles
-    for (int idx : selected_circle_indices) {
-        if (idx < completed_circles.size()) {
-            for (const auto& circle : completed_circles[idx].circles) {
+            case ObjectKind::CIRCLE: {
+                Circle_Data circle = scene.circle(id);
+                bool baked = !transformed || bake_geometry(circle, m);
                 cr->set_source_rgba(0.8, 0.4, 0.2, 0.4); // Orange highlight
                 cr->set_line_width(4.0);
+                cr->save();
+                if (!baked) cr->transform(cairo_matrix(m));
                 cr->arc(circle.x, circle.y, circle.r + 2, 0, 2 * M_PI);
+                cr->restore();
                 cr->stroke();
+                break;
             }
         }
     }
 }
 
-bool CairoDrawingArea::is_point_in_stroke(const Stroke& stroke, double x, double y, double tolerance) {
-    for (const auto& point : stroke.points) {
-        double distance = point_distance(Point(x, y), point);
-        if (distance <= tolerance) {
-            return true;
+void CairoDrawingArea::draw_selection_handles(const Cairo::RefPtr<Cairo::Context>& cr) {
+    if (selection.empty()) return;
+    BoundingBox box = selection_bounds();
+    
+    // Drawn a pixel smaller than they grab, so the damage margin covers them
+    double half = (SELECTION_HANDLE_SIZE - 1.0) / 2.0;
+    double xs[3] = {box.x, box.x + box.width / 2.0, box.x + box.width};
+    double ys[3] = {box.y, box.y + box.height / 2.0, box.y + box.height};
+    for (int row = 0; row < 3; row++) {
+        for (int column = 0; column < 3; column++) {
+            if (row == 1 && column == 1) continue;
+            cr->rectangle(xs[column] - half, ys[row] - half, 2 * half, 2 * half);
         }
     }
-    return false;
+    cr->set_source_rgb(1.0, 1.0, 1.0);
+    cr->fill_preserve();
+    cr->set_source_rgba(0.8, 0.4, 0.2, 1.0); // Orange like the highlights
+    cr->set_line_width(1.0);
+    cr->stroke();
+}
+
+bool CairoDrawingArea::is_point_in_stroke(const Stroke& stroke, double x, double y, double tolerance) {
+    return stroke.hit_test(x, y, tolerance);
 }
 
 bool CairoDrawingArea::is_point_in_rectangle(const Rect& rect, double x, double y) {
@@ -1379,110 +1934,525 @@ bool CairoDrawingArea::is_point_in_rectangle(const Rect& rect, double x, double
 }
 
 bool CairoDrawingArea::is_point_in_circle(const Circle_Data& circle, double x, double y) {
-    double distance = point_distance(Point(x, y), Point(circle.x, circle.y));
-    return distance <= circle.r;
+    return distance_squared(Point(x, y), Point(circle.x, circle.y)) <= circle.r * circle.r;
+}
+
+bool CairoDrawingArea::hit_test_object(ObjectId id, double x, double y, double stroke_tolerance) {
+    // Objects with a pending transform are tested in their own space
+    const Affine& m = scene.transform(id);
+    if (!m.is_identity()) {
+        Point p = m.inverse().apply(Point(x, y));
+        x = p.x;
+        y = p.y;
+        stroke_tolerance /= m.mean_scale();
+    }
+    
+    switch (scene.kind(id)) {
+        case ObjectKind::STROKE: return is_point_in_stroke(scene.stroke(id), x, y, stroke_tolerance);
+        case ObjectKind::RECTANGLE: return is_point_in_rectangle(scene.rect(id), x, y);
+        case ObjectKind::CIRCLE: return is_point_in_circle(scene.circle(id), x, y);
+    }
+    return false;
 }
 
 // Stroke class methods
-void Stroke::complete_stroke() {
-    // Smooth points already calculated in real-time during add_point()
-    // Just clear raw points to free memory
-    raw_points.clear();
+void Stroke::complete_stroke(double fit_tolerance) {
+    // Smooth points already calculated in real-time during add_point();
+    // replace them with a few Bezier segments. Half of the error bound goes
+    // to the centerline fit, half to offsetting the outline at render time.
+    BezierFitResult fitted = fit_bezier_path(points, width, fit_tolerance / 2.0);
+    curve = std::move(fitted.curve);
+    fit_error = fitted.max_error;
+    invalidate_paths();
+    bounds_valid = false;
+    outline_tolerance = fit_tolerance > 0.0 ? fit_tolerance / 2.0 : smoother.get_tolerance();
+    
+    // The curve is the stored format: drop the polyline and the smoothing window
+    smoother.reset();
+    points.clear();
+    points.shrink_to_fit();
+    sample_times.shrink_to_fit();
+}
+
+static void append_bezier_path(const Cairo::RefPtr<Cairo::Context>& cr, const StrokePoints& path) {
+    cr->move_to(path[0].x, path[0].y);
+    for (size_t i = 1; i + 2 < path.size(); i += 3) {
+        Point c1 = path[i], c2 = path[i + 1], end = path[i + 2];
+        cr->curve_to(c1.x, c1.y, c2.x, c2.y, end.x, end.y);
+    }
+}
+
+// Identity-transform context that only records paths for copy_path()
+static const Cairo::RefPtr<Cairo::Context>& path_recorder() {
+    static Cairo::RefPtr<Cairo::Context> recorder =
+        Cairo::Context::create(Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, 1, 1));
+    return recorder;
+}
+
+static std::shared_ptr<Cairo::Path> record_bezier_path(const StrokePoints& path, bool closed) {
+    const auto& recorder = path_recorder();
+    recorder->begin_new_path();
+    append_bezier_path(recorder, path);
+    if (closed) recorder->close_path();
+    std::shared_ptr<Cairo::Path> recorded(recorder->copy_path());
+    recorder->begin_new_path();
+    return recorded;
+}
+
+void Stroke::append_centerline_path(const Cairo::RefPtr<Cairo::Context>& cr) const {
+    if (is_fitted()) {
+        if (!centerline_path) centerline_path = record_bezier_path(curve, false);
+        cr->append_path(*centerline_path);
+        return;
+    }
+    if (points.empty()) return;
+    
+    // Still being drawn: changes every frame, not worth caching
+    cr->move_to(points[0].x, points[0].y);
+    for (size_t i = 1; i < points.size(); i++) {
+        cr->line_to(points[i].x, points[i].y);
+    }
 }
 
-// Background surface management (dual-layer architecture like Electron app)
-void CairoDrawingArea::initialize_background_surface(int width, int height) {
-    // Create background surface to cache completed strokes (like SVG layer)
-    background_surface = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32, width, height);
-    background_context = Cairo::Context::create(background_surface);
+void Stroke::append_centerline_path(const Cairo::RefPtr<Cairo::Context>& cr, const BoundingBox& area) const {
+    if (is_fitted()) {
+        append_centerline_path(cr);
+        return;
+    }
     
-    // Clear to transparent
-    background_context->set_source_rgba(0, 0, 0, 0);
-    background_context->paint();
+    // A segment matters if its line (width / 2 around it) can reach the area
+    double pad = width / 2.0;
+    BoundingBox reach(area.x - pad, area.y - pad, area.width + 2 * pad, area.height + 2 * pad);
     
-    background_dirty = false;
+    // Consecutive matching segments form one sub-path; the round join at a
+    // break covers whatever the round caps there would add
+    bool in_run = false;
+    for (size_t i = 1; i < points.size(); i++) {
+        Point a = points[i - 1], b = points[i];
+        BoundingBox segment(std::min(a.x, b.x), std::min(a.y, b.y), std::abs(b.x - a.x), std::abs(b.y - a.y));
+        if (!segment.intersects(reach)) {
+            in_run = false;
+            continue;
+        }
+        if (!in_run) cr->move_to(a.x, a.y);
+        cr->line_to(b.x, b.y);
+        in_run = true;
+    }
 }
 
-void CairoDrawingArea::render_stroke_to_background(const Stroke& stroke) {
-    if (!background_context || stroke.points.size() < 2) return;
+void Stroke::append_outline_path(const Cairo::RefPtr<Cairo::Context>& cr) const {
+    if (!is_fitted()) return;
     
-    // Render completed stroke to background surface (cached layer)
-    background_context->set_source_rgba(stroke.color.r, stroke.color.g, stroke.color.b, stroke.color.a);
-    background_context->set_line_width(stroke.width);
-    background_context->set_line_cap(Cairo::Context::LineCap::ROUND);
-    background_context->set_line_join(Cairo::Context::LineJoin::ROUND);
+    // Offset from the curve on first use so only the centerline is stored
+    if (!outline_path) outline_path = record_bezier_path(build_bezier_outline(curve, width, outline_tolerance), true);
+    cr->append_path(*outline_path);
+}
+
+// Box around points [first, end) padded by the widest half-width among them
+static BoundingBox path_bounds(const StrokePoints& path, size_t first, double width, double* padding_out = nullptr) {
+    if (first >= path.size()) return BoundingBox();
     
-    // Draw the smooth stroke path to background
-    background_context->move_to(stroke.points[0].x, stroke.points[0].y);
-    for (size_t i = 1; i < stroke.points.size(); i++) {
-        background_context->line_to(stroke.points[i].x, stroke.points[i].y);
+    double min_x = path[first].x, max_x = path[first].x;
+    double min_y = path[first].y, max_y = path[first].y;
+    double max_width_scale = 0.0;
+    for (size_t i = first; i < path.size(); i++) {
+        Point p = path[i];
+        min_x = std::min(min_x, p.x);
+        max_x = std::max(max_x, p.x);
+        min_y = std::min(min_y, p.y);
+        max_y = std::max(max_y, p.y);
+        max_width_scale = std::max(max_width_scale, path.width_scale(i));
+    }
+    
+    // Add stroke width padding
+    double padding = width * std::max(1.0, max_width_scale) / 2.0;
+    if (padding_out) *padding_out = padding;
+    return BoundingBox(min_x - padding, min_y - padding, 
+                      max_x - min_x + 2*padding, max_y - min_y + 2*padding);
+}
+
+BoundingBox Stroke::get_bounds() const {
+    // Live points change with every sample; only completed strokes keep their box
+    if (!is_fitted()) return path_bounds(points, 0, width);
+    
+    // Bezier control points enclose their curve, so their box is a safe bound
+    if (!bounds_valid) {
+        bounds = path_bounds(curve, 0, width, &bounds_padding);
+        bounds_valid = true;
+    }
+    return bounds;
+}
+
+size_t Stroke::memory_bytes() const {
+    return sizeof(Stroke) + points.memory_bytes() + curve.memory_bytes() + sample_times.capacity() * sizeof(uint32_t);
+}
+
+void Stroke::write(std::ostream& out) const {
+    points.write(out);
+    curve.write(out);
+    write_value(out, color);
+    write_value(out, width);
+    write_value(out, fit_error);
+    write_value(out, outline_tolerance);
+    write_value(out, start_time);
+    write_vector(out, sample_times);
+}
+
+bool Stroke::read(std::istream& in) {
+    invalidate_paths();
+    bounds_valid = false;
+    return points.read(in) && curve.read(in) &&
+           read_value(in, color) && read_value(in, width) && read_value(in, fit_error) &&
+           read_value(in, outline_tolerance) && read_value(in, start_time) && read_vector(in, sample_times);
+}
+
+size_t SceneObject::memory_bytes() const {
+    if (kind() == ObjectKind::STROKE) return sizeof(SceneObject) + std::get<Stroke>(shape).memory_bytes() - sizeof(Stroke);
+    return sizeof(SceneObject);
+}
+
+size_t SceneEdit::bytes() const {
+    size_t total = sizeof(SceneEdit) + ids.capacity() * sizeof(ObjectId) + weights.capacity() * sizeof(double);
+    for (const auto& object : stash) total += object.memory_bytes();
+    return total;
+}
+
+void SceneEdit::write(std::ostream& out) const {
+    write_value(out, type);
+    write_vector(out, ids);
+    write_value(out, dx);
+    write_value(out, dy);
+    write_value(out, scale_x);
+    write_value(out, scale_y);
+    write_value(out, origin_x);
+    write_value(out, origin_y);
+    write_vector(out, weights);
+    
+    write_value(out, (uint64_t)stash.size());
+    for (const auto& object : stash) {
+        write_value(out, object.id);
+        write_value(out, (uint64_t)object.depth);
+        write_value(out, object.kind());
+        write_value(out, object.transform);
+        switch (object.kind()) {
+            case ObjectKind::STROKE: std::get<Stroke>(object.shape).write(out); break;
+            case ObjectKind::RECTANGLE: write_value(out, std::get<Rect>(object.shape)); break;
+            case ObjectKind::CIRCLE: write_value(out, std::get<Circle_Data>(object.shape)); break;
+        }
     }
-    background_context->stroke();
 }
 
-void CairoDrawingArea::render_rectangle_to_background(const Rectangle& rectangle) {
-    if (!background_context) return;
+bool SceneEdit::read(std::istream& in) {
+    uint64_t count = 0;
+    if (!(read_value(in, type) && read_vector(in, ids) &&
+          read_value(in, dx) && read_value(in, dy) && read_value(in, scale_x) && read_value(in, scale_y) &&
+          read_value(in, origin_x) && read_value(in, origin_y) && read_vector(in, weights) &&
+          read_value(in, count))) {
+        return false;
+    }
+    if (type == Type::RESIZE && weights.size() != ids.size()) return false;
     
-    for (const auto& rect : rectangle.rects) {
-        background_context->set_source_rgb(rect.color.r, rect.color.g, rect.color.b);
-        background_context->set_line_width(2.0);
-        background_context->rectangle(rect.x, rect.y, rect.width, rect.height);
-        background_context->stroke();
+    stash.clear();
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t depth = 0;
+        ObjectKind kind = ObjectKind::STROKE;
+        SceneObject object{NO_OBJECT, 0, Stroke()};
+        if (!(read_value(in, object.id) && read_value(in, depth) && read_value(in, kind) &&
+              read_value(in, object.transform))) {
+            return false;
+        }
+        object.depth = (size_t)depth;
+        
+        bool ok = false;
+        switch (kind) {
+            case ObjectKind::STROKE:
+                ok = std::get<Stroke>(object.shape).read(in);
+                break;
+            case ObjectKind::RECTANGLE:
+                object.shape = Rect(0, 0, 0, 0, Color());
+                ok = read_value(in, std::get<Rect>(object.shape));
+                break;
+            case ObjectKind::CIRCLE:
+                object.shape = Circle_Data(0, 0, 0, Color());
+                ok = read_value(in, std::get<Circle_Data>(object.shape));
+                break;
+        }
+        if (!ok) return false;
+        stash.push_back(std::move(object));
     }
+    return true;
+}
+
+BoundingBox Stroke::get_tail_bounds(size_t first_point) const {
+    return path_bounds(points, first_point, width);
 }
 
-void CairoDrawingArea::render_circle_to_background(const Circle& circle) {
-    if (!background_context) return;
+bool Stroke::hit_test(double x, double y, double radius) const {
+    // The padded bounds also enclose the bare centerline
+    if (!box_intersects_circle(get_bounds(), Point(x, y), radius)) return false;
     
-    for (const auto& c : circle.circles) {
-        background_context->set_source_rgb(c.color.r, c.color.g, c.color.b);
-        background_context->set_line_width(2.0);
-        background_context->arc(c.x, c.y, c.r, 0, 2 * M_PI);
-        background_context->stroke();
+    if (is_fitted()) return bezier_path_near(curve, x, y, radius);
+    return polyline_intersects_circle(points, 0.0, Point(x, y), radius);
+}
+
+bool Stroke::intersects_circle(double x, double y, double radius) const {
+    return intersects_capsule(Point(x, y), Point(x, y), radius);
+}
+
+bool Stroke::intersects_capsule(const Point& a, const Point& b, double radius) const {
+    if (segment_box_distance_squared(a, b, get_bounds()) > radius * radius) return false;
+    
+    if (is_fitted()) return bezier_path_near(curve, a, b, radius, width);
+    return polyline_intersects_capsule(points, width, a, b, radius);
+}
+
+bool Stroke::erase_capsule(const Point& a, const Point& b, double radius, std::vector<Stroke>& pieces) const {
+    if (segment_box_distance_squared(a, b, get_bounds()) > radius * radius) return false;
+    
+    // A live polyline is cut as a chain of straight cubics
+    StrokePoints straight;
+    if (!is_fitted()) straight = fit_bezier_path(points, width, 0.0).curve;
+    
+    std::vector<StrokePoints> parts;
+    if (!bezier_path_erase(is_fitted() ? curve : straight, a, b, radius, width, parts)) return false;
+    
+    for (auto& part : parts) {
+        Stroke piece(width, color);
+        piece.curve = std::move(part);
+        piece.fit_error = fit_error;
+        piece.outline_tolerance = outline_tolerance;
+        pieces.push_back(std::move(piece));
     }
+    return true;
 }
 
-void CairoDrawingArea::erase_from_background(double x, double y, double radius) {
-    if (!background_context) return;
+void Stroke::translate(double dx, double dy) {
+    points.translate(dx, dy);
+    curve.translate(dx, dy);
+    invalidate_paths();
     
-    // Erase from background surface using destination-out blend mode
-    background_context->save();
-    background_context->set_operator(Cairo::Context::Operator::DEST_OUT);
-    background_context->arc(x, y, radius, 0, 2 * M_PI);
-    background_context->fill();
-    background_context->restore();
+    // A shifted box is still exact
+    bounds.x += dx;
+    bounds.y += dy;
+}
+
+void Stroke::scale(double scale_x, double scale_y, double origin_x, double origin_y) {
+    // Beziers are affine invariant: scaling the control points scales the curve exactly
+    points.scale(scale_x, scale_y, origin_x, origin_y);
+    curve.scale(scale_x, scale_y, origin_x, origin_y);
+    width *= std::min(scale_x, scale_y); // Scale line width proportionally
+    invalidate_paths();
+    
+    // The point box scales with the points and the padding with the width
+    if (bounds_valid) {
+        double x1 = origin_x + (bounds.x + bounds_padding - origin_x) * scale_x;
+        double y1 = origin_y + (bounds.y + bounds_padding - origin_y) * scale_y;
+        double x2 = origin_x + (bounds.x + bounds.width - bounds_padding - origin_x) * scale_x;
+        double y2 = origin_y + (bounds.y + bounds.height - bounds_padding - origin_y) * scale_y;
+        bounds_padding *= std::min(scale_x, scale_y);
+        bounds = BoundingBox(std::min(x1, x2) - bounds_padding, std::min(y1, y2) - bounds_padding,
+                             std::abs(x2 - x1) + 2 * bounds_padding, std::abs(y2 - y1) + 2 * bounds_padding);
+    }
+}
+
+// Background surface management (dual-layer architecture like Electron app)
+void CairoDrawingArea::initialize_background_surface(int width, int height) {
+    // Tiles are allocated and rendered lazily on the next draw
+    background_tiles.resize(width, height);
+    background_tiles.set_scale(std::max(1, get_scale_factor()));
+}
+
+void CairoDrawingArea::render_stroke_to_background(const Stroke& stroke) {
+    if (!stroke.is_fitted() && stroke.points.size() < 2) return;
+    
+    // Draw the new stroke on top of the clean tiles it covers; dirty ones pick it up when re-rendered
+    BoundingBox bounds = stroke.get_bounds();
+    damage_area(bounds);
+    for (auto* tile : background_tiles.clean_tiles_in(bounds.x, bounds.y, bounds.width, bounds.height)) {
+        draw_smooth_stroke(tile->context, stroke);
+    }
+}
+
+void CairoDrawingArea::render_rectangle_to_background(const Rect& rect) {
+    BoundingBox bounds = rect_bounds(rect);
+    damage_area(bounds);
+    for (auto* tile : background_tiles.clean_tiles_in(bounds.x, bounds.y, bounds.width, bounds.height)) {
+        draw_rect_outline(tile->context, rect);
+    }
+}
+
+void CairoDrawingArea::render_circle_to_background(const Circle_Data& circle) {
+    BoundingBox bounds = circle_bounds(circle);
+    damage_area(bounds);
+    for (auto* tile : background_tiles.clean_tiles_in(bounds.x, bounds.y, bounds.width, bounds.height)) {
+        draw_circle_outline(tile->context, circle);
+    }
+}
+
+void CairoDrawingArea::invalidate_background(const BoundingBox& area) {
+    background_tiles.invalidate(area.x, area.y, area.width, area.height);
+    damage_area(area);
 }
 
 void CairoDrawingArea::rebuild_background_surface() {
-    if (!background_context) return;
-    
-    // Clear background surface
-    background_context->save();
-    background_context->set_operator(Cairo::Context::Operator::CLEAR);
-    background_context->paint();
-    background_context->restore();
-    
-    // Re-render all remaining strokes
-    for (const auto& stroke : completed_strokes) {
-        render_stroke_to_background(stroke);
-    }
-    
-    // Re-render rectangles and circles to background too
-    for (const auto& rectangle : completed_rectangles) {
-        for (const auto& rect : rectangle.rects) {
-            background_context->set_source_rgb(rect.color.r, rect.color.g, rect.color.b);
-            background_context->set_line_width(2.0);
-            background_context->rectangle(rect.x, rect.y, rect.width, rect.height);
-            background_context->stroke();
-        }
+    background_tiles.invalidate_all();
+    full_damage = true;
+}
+
+// Opaque round-capped segments (first - 1 -> first) .. (last - 2 -> last - 1), each as wide as
+// the stroke at its ends; overlapping caps of one color merge into a variable-width line
+static void draw_ink_segments(const Cairo::RefPtr<Cairo::Context>& cr, const Stroke& stroke, size_t first, size_t last) {
+    const StrokePoints& points = stroke.points;
+    cr->set_source_rgb(stroke.color.r, stroke.color.g, stroke.color.b);
+    cr->set_line_cap(Cairo::Context::LineCap::ROUND);
+    if (points.size() == 1 && first == 0 && last > 0) {
+        // A tap: a zero-length segment with round caps is a dot
+        cr->set_line_width(stroke.width * points.width_scale(0));
+        cr->move_to(points[0].x, points[0].y);
+        cr->line_to(points[0].x, points[0].y);
+        cr->stroke();
+        return;
+    }
+    for (size_t i = std::max<size_t>(first, 1); i < last && i < points.size(); i++) {
+        Point a = points[i - 1], b = points[i];
+        cr->set_line_width(stroke.width * (points.width_scale(i - 1) + points.width_scale(i)) / 2.0);
+        cr->move_to(a.x, a.y);
+        cr->line_to(b.x, b.y);
+        cr->stroke();
+    }
+}
+
+void CairoDrawingArea::begin_wet_ink() {
+    int width = std::max(get_width(), 1), height = std::max(get_height(), 1);
+    int scale = std::max(1, get_scale_factor());
+    if (!wet_surface || wet_surface->get_width() != width * scale || wet_surface->get_height() != height * scale) {
+        wet_surface = create_layer_surface(width, height, scale);
+        wet_context = Cairo::Context::create(wet_surface);
+    }
+    wet_points = 0;
+}
+
+void CairoDrawingArea::update_wet_ink() {
+    // Points before the stable count never change, so each segment is drawn exactly once
+    size_t stable = current_stroke.stable_point_count();
+    if (!wet_context || stable <= wet_points) return;
+    
+    draw_ink_segments(wet_context, current_stroke, wet_points, stable);
+    wet_points = stable;
+}
+
+void CairoDrawingArea::draw_wet_ink(const Cairo::RefPtr<Cairo::Context>& cr) {
+    if (!wet_surface) return;
+    
+    // Wet layer and tail are opaque inside the group so the joint between them
+    // doesn't blend twice; the stroke alpha is applied once to the whole group
+    cr->push_group();
+    cr->set_source(wet_surface, 0, 0);
+    cr->paint();
+    draw_ink_segments(cr, current_stroke, wet_points, current_stroke.points.size());
+    cr->pop_group_to_source();
+    cr->paint_with_alpha(current_stroke.color.a);
+}
+
+void CairoDrawingArea::commit_wet_ink() {
+    if (!wet_context) return;
+    
+    // Every point is final once the pen is up
+    draw_ink_segments(wet_context, current_stroke, wet_points, current_stroke.points.size());
+    wet_points = current_stroke.points.size();
+    
+    // Clean tiles get the wet pixels; dirty ones re-render from the stored curve anyway
+    BoundingBox bounds = current_stroke.get_bounds();
+    for (auto* tile : background_tiles.clean_tiles_in(bounds.x, bounds.y, bounds.width, bounds.height)) {
+        tile->context->save();
+        tile->context->rectangle(bounds.x, bounds.y, bounds.width, bounds.height);
+        tile->context->clip();
+        tile->context->set_source(wet_surface, 0, 0);
+        tile->context->paint_with_alpha(current_stroke.color.a);
+        tile->context->restore();
+    }
+    
+    // Leave the wet layer clean for the next stroke, touching only this one's area
+    wet_context->save();
+    wet_context->rectangle(bounds.x - 1, bounds.y - 1, bounds.width + 2, bounds.height + 2);
+    wet_context->clip();
+    wet_context->set_operator(Cairo::Context::Operator::CLEAR);
+    wet_context->paint();
+    wet_context->restore();
+}
+
+void CairoDrawingArea::damage_area(const BoundingBox& area) {
+    if (area.width <= 0 && area.height <= 0) return;
+    if (!damage) damage = Cairo::Region::create();
+    
+    int x1 = (int)std::floor(area.x - DAMAGE_MARGIN);
+    int y1 = (int)std::floor(area.y - DAMAGE_MARGIN);
+    int x2 = (int)std::ceil(area.x + area.width + DAMAGE_MARGIN);
+    int y2 = (int)std::ceil(area.y + area.height + DAMAGE_MARGIN);
+    damage->do_union(Cairo::RectangleInt{x1, y1, x2 - x1, y2 - y1});
+}
+
+void CairoDrawingArea::damage_live_stroke() {
+    // Tail points the smoother re-emitted have moved away from where the last frame drew them
+    damage_area(live_tail_bounds);
+    
+    // Everything from the last stable point on is new or re-emitted
+    size_t first = live_stable_points > 0 ? live_stable_points - 1 : 0;
+    damage_area(current_stroke.get_tail_bounds(first));
+    
+    live_stable_points = current_stroke.stable_point_count();
+    live_tail_bounds = current_stroke.get_tail_bounds(live_stable_points > 0 ? live_stable_points - 1 : 0);
+}
+
+BoundingBox CairoDrawingArea::preview_bounds() const {
+    Point start = is_drawing_rectangle ? rectangle_start : selection_start;
+    if (is_drawing_circle) {
+        double r = sqrt(pow(current_mouse_pos.x - circle_start.x, 2) + pow(current_mouse_pos.y - circle_start.y, 2));
+        return BoundingBox(circle_start.x - r, circle_start.y - r, 2 * r, 2 * r);
+    }
+    if (!is_drawing_rectangle && !is_selecting) return BoundingBox();
+    
+    return BoundingBox(std::min(start.x, current_mouse_pos.x), std::min(start.y, current_mouse_pos.y),
+                       std::abs(current_mouse_pos.x - start.x), std::abs(current_mouse_pos.y - start.y));
+}
+
+void CairoDrawingArea::queue_damage() {
+    if (full_damage || (damage && !damage->empty())) queue_draw();
+}
+
+void CairoDrawingArea::queue_full_draw() {
+    full_damage = true;
+    queue_draw();
+}
+
+void CairoDrawingArea::update_background_tiles() {
+    std::vector<BackgroundTile*> dirty = background_tiles.dirty_tiles();
+    if (dirty.empty()) return;
+    
+    for (auto* tile : dirty) {
+        background_tiles.begin_tile(*tile);
+    }
+    
+    // Only the objects the index finds under the dirty tiles (with the pixel of
+    // antialiasing overlaps() allows), in drawing order so overlaps stack the
+    // same way in every tile; an object is drawn only into the dirty tiles its
+    // bounds reach
+    std::vector<ObjectId> candidates;
+    for (auto* tile : dirty) {
+        std::vector<ObjectId> hits = scene.query_rect(BoundingBox(tile->x - 1.0, tile->y - 1.0,
+                                                                  BACKGROUND_TILE_SIZE + 2.0, BACKGROUND_TILE_SIZE + 2.0));
+        candidates.insert(candidates.end(), hits.begin(), hits.end());
     }
+    std::sort(candidates.begin(), candidates.end(), [this](ObjectId a, ObjectId b) { return scene.depth(a) < scene.depth(b); });
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
     
-    for (const auto& circle : completed_circles) {
-        for (const auto& c : circle.circles) {
-            background_context->set_source_rgb(c.color.r, c.color.g, c.color.b);
-            background_context->set_line_width(2.0);
-            background_context->arc(c.x, c.y, c.r, 0, 2 * M_PI);
-            background_context->stroke();
+    // Objects the eraser has staged are already gone as far as the background is concerned
+    for (ObjectId id : candidates) {
+        if (current_eraser.is_erased(id)) continue;
+        if ((is_lifted || is_resizing) && selection.contains(id)) continue;  // Drawn on its own while dragged
+        BoundingBox bounds = scene.bounds(id);
+        for (auto* tile : dirty) {
+            if (tile->overlaps(bounds.x, bounds.y, bounds.width, bounds.height)) draw_object(tile->context, id);
         }
     }
 }
@@ -1494,7 +2464,7 @@ void on_tool_changed(const std::string& tool_name, CairoDrawingArea* drawing_are
     drawing_area->set_drawing_state(tool_name);
     
     // Clear selections when switching tools
-    if (tool_name != "select") {
+    if (tool_name != "select" && tool_name != "lasso") {
         drawing_area->clear_selection();
     }
 }
@@ -4,17 +4,22 @@
 #include <cairomm/cairomm.h>
 #include <vector>
 #include <chrono>
+#include <cstdint>
 #include <cmath>
 #include <memory>
 #include <string>
+#include <variant>
 #include "settingPanel.hpp"
-
-struct Point {
-    double x, y;
-    long long timestamp;
-    
-    Point(double x, double y);
-};
+#include "strokeSmoother.hpp"
+#include "strokeOutline.hpp"
+#include "bezierFit.hpp"
+#include "tileCache.hpp"
+#include "geometry.hpp"
+#include "spatialGrid.hpp"
+#include "lassoPolygon.hpp"
+#include "selectionSet.hpp"
+#include "undoLog.hpp"
+#include "binaryStream.hpp"
 
 struct Color {
     double r, g, b, a;
@@ -37,190 +42,259 @@ struct Circle_Data{
     Circle_Data(double x, double y, double r, Color color);
 };
 
-// Bounding box for selection and collision detection
-struct BoundingBox {
-    double x, y, width, height;
-    
-    BoundingBox(double x = 0, double y = 0, double w = 0, double h = 0) 
-        : x(x), y(y), width(w), height(h) {}
-    
-    bool contains_point(double px, double py) const {
-        return px >= x && px <= x + width && py >= y && py <= y + height;
-    }
-};
-
 // Selection handle positions for resizing
 enum class HandlePosition {
     TOP_LEFT, TOP_RIGHT, BOTTOM_LEFT, BOTTOM_RIGHT,
     TOP, BOTTOM, LEFT, RIGHT, NONE
 };
 
-// Base class for all drawable objects
-class DrawableObject {
-public:
-    virtual ~DrawableObject() = default;
-    
-    // Core functionality
-    virtual void draw(const Cairo::RefPtr<Cairo::Context>& cr) const = 0;
-    virtual BoundingBox get_bounding_box() const = 0;
-    virtual bool hit_test(double x, double y) const = 0;
-    virtual std::string get_type() const = 0;
-    
-    // Transformation methods
-    virtual void translate(double dx, double dy) = 0;
-    virtual void scale(double scale_x, double scale_y, double origin_x, double origin_y) = 0;
-    
-    // Selection state
-    bool is_selected = false;
-    
-    // Handle detection for resizing
-    HandlePosition get_handle_at_point(double x, double y) const;
-    void draw_selection_handles(const Cairo::RefPtr<Cairo::Context>& cr) const;
-
-};
-
 class Stroke {
 public:
-    std::vector<Point> points;  // Contains calculated smooth points (updated in real-time)
+    StrokePoints points;  // Smooth points while drawing; released once the stroke is fitted
+    StrokePoints curve;  // Fitted cubic Beziers with width scales, the stored format of completed strokes
     Color color;
     double width;
+    double fit_error = 0.0;  // Max deviation (canvas units) of the fitted centerline from the tessellated one
     
     Stroke(double w = 3.0, Color col = Color(0.0, 0.0, 0.8)) 
         : width(w), color(col) {}
     
-    void add_point(double x, double y);  // Calculates smooth points in real-time
-    void complete_stroke();  // Clears raw points to save memory
+    void add_point(const InputSample& sample);  // Calculates smooth points in real-time
+    size_t add_samples(const std::vector<InputSample>& samples, double min_distance = 0.5);  // Batch of motion history
+    void complete_stroke(double fit_tolerance = 0.0);  // Fits Beziers and drops the polyline
+    bool is_fitted() const { return !curve.empty(); }
+    // Fitted strokes append cached paths; both are rebuilt after translate() or scale()
+    void append_centerline_path(const Cairo::RefPtr<Cairo::Context>& cr) const;
+    void append_centerline_path(const Cairo::RefPtr<Cairo::Context>& cr, const BoundingBox& area) const;  // Live segments reaching area
+    void append_outline_path(const Cairo::RefPtr<Cairo::Context>& cr) const;  // Filled variable-width outline
+    BoundingBox get_bounds() const;  // Cached once fitted; translate() and scale() update it in place
+    BoundingBox get_tail_bounds(size_t first_point) const;  // Live points from first_point on
+    size_t stable_point_count() const { return smoother.get_finalized_points(); }  // Live points that won't move again
+    bool hit_test(double x, double y, double radius) const;  // Centerline within radius of (x, y)
+    bool intersects_circle(double x, double y, double radius) const;  // Inked area (with its width) overlaps the circle
+    bool intersects_capsule(const Point& a, const Point& b, double radius) const;  // Same for a circle swept from a to b
+    // Cuts away the parts the swept circle covers; false, with no pieces, if it misses
+    bool erase_capsule(const Point& a, const Point& b, double radius, std::vector<Stroke>& pieces) const;
+    void translate(double dx, double dy);
+    void scale(double scale_x, double scale_y, double origin_x, double origin_y);
+    void set_width(double w) { width = w; bounds_valid = false; invalidate_paths(); }  // Keeps the width scales
+    void set_flatness_tolerance(double tolerance) { smoother.set_tolerance(tolerance); }
+    size_t memory_bytes() const;  // Geometry and timing, without the cached paths
+    // Completed strokes only: the fitted curve, style and timing, not the drawing state
+    void write(std::ostream& out) const;
+    bool read(std::istream& in);
+    void release_paths() { invalidate_paths(); }  // For copies that are only stored, not drawn
+    
+    // Raw input timing: one entry per raw sample, milliseconds since the first sample
+    const std::vector<uint32_t>& get_sample_times() const { return sample_times; }
     
 private:
-    std::vector<Point> raw_points;  // Temporary storage during drawing
+    StrokeSmoother smoother;  // Temporary state during drawing
+    double outline_tolerance = DEFAULT_FLATNESS_TOLERANCE;  // Offset error allowed when building the outline
+    uint32_t start_time = 0;
+    std::vector<uint32_t> sample_times;
+    
+    // Recorded once with copy_path() and shared between copies of the stroke
+    mutable std::shared_ptr<Cairo::Path> outline_path;
+    mutable std::shared_ptr<Cairo::Path> centerline_path;
+    void invalidate_paths() { outline_path.reset(); centerline_path.reset(); }
+    
+    mutable BoundingBox bounds;  // Valid for fitted strokes only
+    mutable double bounds_padding = 0.0;  // Half-width margin included in bounds
+    mutable bool bounds_valid = false;
 };
 
-// Concrete drawable object implementations
-class StrokeObject : public DrawableObject {
-private:
-    Stroke stroke;
-    
-public:
-    StrokeObject(const Stroke& s) : stroke(s) {}
-    
-    void draw(const Cairo::RefPtr<Cairo::Context>& cr) const override;
-    BoundingBox get_bounding_box() const override;
-    bool hit_test(double x, double y) const override;
-    std::string get_type() const override { return "stroke"; }
-    
-    void translate(double dx, double dy) override;
-    void scale(double scale_x, double scale_y, double origin_x, double origin_y) override;
-    
-    const Stroke& get_stroke() const { return stroke; }
-    Stroke& get_stroke() { return stroke; }
-};
+// Stable handle of an object in the scene; never reused before the scene is
+// cleared, so undo can put an object back under the same ID
+using ObjectId = uint32_t;
+constexpr ObjectId NO_OBJECT = UINT32_MAX;
 
-class RectangleObject : public DrawableObject {
-private:
-    Rect rect;
-    
-public:
-    RectangleObject(const Rect& r) : rect(r) {}
-    
-    void draw(const Cairo::RefPtr<Cairo::Context>& cr) const override;
-    BoundingBox get_bounding_box() const override;
-    bool hit_test(double x, double y) const override;
-    std::string get_type() const override { return "rectangle"; }
-    
-    void translate(double dx, double dy) override;
-    void scale(double scale_x, double scale_y, double origin_x, double origin_y) override;
-    
-    const Rect& get_rect() const { return rect; }
-    Rect& get_rect() { return rect; }
-};
+enum class ObjectKind : uint8_t { STROKE, RECTANGLE, CIRCLE };
 
-class CircleObject : public DrawableObject {
-private:
-    Circle_Data circle;
-    
-public:
-    CircleObject(const Circle_Data& c) : circle(c) {}
-    
-    void draw(const Cairo::RefPtr<Cairo::Context>& cr) const override;
-    BoundingBox get_bounding_box() const override;
-    bool hit_test(double x, double y) const override;
-    std::string get_type() const override { return "circle"; }
+// An object taken out of the scene, with what it takes to put it back as it was
+struct SceneObject {
+    ObjectId id;
+    size_t depth;  // Position in the drawing order it goes back to
+    std::variant<Stroke, Rect, Circle_Data> shape;  // Alternatives in ObjectKind order
+    Affine transform;  // Still pending on the geometry
     
-    void translate(double dx, double dy) override;
-    void scale(double scale_x, double scale_y, double origin_x, double origin_y) override;
-    
-    const Circle_Data& get_circle() const { return circle; }
-    Circle_Data& get_circle() { return circle; }
+    ObjectKind kind() const { return (ObjectKind)shape.index(); }
+    size_t memory_bytes() const;
 };
 
-// Selection manager for handling multiple selections
-class SelectionManager {
-private:
-    std::vector<std::shared_ptr<DrawableObject>> selected_objects;
-    
+// Every completed object on the canvas. Geometry lives in one contiguous
+// array per kind (removal swaps the last element into the hole), an ID table
+// maps each object to its kind and slot, and a z-order list of IDs gives the
+// drawing order. One spatial index keyed by ID covers all kinds.
+class SceneStore {
 public:
-    void clear_selection();
-    void add_to_selection(std::shared_ptr<DrawableObject> obj);
-    void remove_from_selection(std::shared_ptr<DrawableObject> obj);
-    bool is_selected(std::shared_ptr<DrawableObject> obj) const;
-    
-    const std::vector<std::shared_ptr<DrawableObject>>& get_selected() const { return selected_objects; }
-    bool has_selection() const { return !selected_objects.empty(); }
-    
-    BoundingBox get_selection_bounds() const;
-    void move_selection(double dx, double dy);
-    void scale_selection(double scale_x, double scale_y, double origin_x, double origin_y);
-};
+    ObjectId add_stroke(Stroke stroke);  // On top of the drawing order
+    ObjectId add_rectangle(const Rect& rect);
+    ObjectId add_circle(const Circle_Data& circle);
+    ObjectId add_stroke_above(ObjectId below, Stroke stroke);  // Right above `below` in the drawing order
+
+    // Copy of an object at its current depth with its pending transform; the copy drops the stroke's cached paths
+    SceneObject copy(ObjectId id) const;
+    // Takes the objects out, ascending by depth, for restore() to put back
+    std::vector<SceneObject> extract(const std::vector<ObjectId>& ids);
+    // Puts objects back under their old IDs, inserting in the order given; returns the IDs
+    std::vector<ObjectId> restore(std::vector<SceneObject> objects);
+
+    // Removes the objects from the arrays, the index and the drawing order (one compaction pass)
+    void remove(const std::vector<ObjectId>& ids);
+    void unindex(ObjectId id) { index.remove(id); }  // Out of queries only; stays drawn until removed
+    void clear();
+
+    bool contains(ObjectId id) const { return id < slots.size() && slots[id].live; }
+    ObjectKind kind(ObjectId id) const { return slots[id].kind; }
+    size_t depth(ObjectId id) const { return slots[id].depth; }  // Position in the drawing order
+    size_t size() const { return order.size(); }
+    ObjectId id_limit() const { return (ObjectId)slots.size(); }  // Every ID handed out is below this
+    const std::vector<ObjectId>& z_order() const { return order; }  // Bottom first
+
+    const Stroke& stroke(ObjectId id) const { return strokes[slots[id].slot]; }
+    const Rect& rect(ObjectId id) const { return rects[slots[id].slot]; }
+    const Circle_Data& circle(ObjectId id) const { return circles[slots[id].slot]; }
+    BoundingBox bounds(ObjectId id) const;  // Painted area, pending transform included
+
+    // Moves and resizes compose into a per-object transform in O(1); objects
+    // are drawn and hit-tested through it until bake() writes it into the
+    // geometry. The index follows every change.
+    const Affine& transform(ObjectId id) const { return transforms[id]; }
+    void set_transform(ObjectId id, const Affine& transform);
+    void translate(ObjectId id, double dx, double dy);
+    void scale(ObjectId id, double scale_x, double scale_y, double origin_x, double origin_y);
+    bool bake(ObjectId id);  // False, leaving it pending, if the geometry can't express the transform (rotation)
+    // Stroke width or circle radius, which scale by the smaller factor and so
+    // don't come back from inverting a non-uniform scale; 0 for rectangles
+    double weight(ObjectId id) const;
+    void set_weight(ObjectId id, double weight);  // Ignored for rectangles
+
+    // Indexed objects whose box meets the area, in drawing order
+    std::vector<ObjectId> query_rect(const BoundingBox& area) const;
+    std::vector<ObjectId> query_radius(double x, double y, double radius) const;
 
-class Circle{
-    public:
-        std::vector<Circle_Data> circles;
-
-        void add_circle(double x, double y, double r, Color color);
+private:
+    struct Slot {
+        ObjectKind kind = ObjectKind::STROKE;
+        uint32_t slot = 0;  // Position in the array of its kind
+        uint32_t depth = 0;
+        bool live = false;
+    };
+    std::vector<Slot> slots;  // By ID
+    std::vector<Affine> transforms;  // By ID, identity once baked
+
+    std::vector<Stroke> strokes;
+    std::vector<Rect> rects;
+    std::vector<Circle_Data> circles;
+    // Owner of each array element, to fix up the ID table after a swap
+    std::vector<ObjectId> stroke_ids;
+    std::vector<ObjectId> rect_ids;
+    std::vector<ObjectId> circle_ids;
+
+    std::vector<ObjectId> order;  // Drawing order, bottom first
+    SpatialGrid index;
+
+    ObjectId new_id(ObjectKind kind, uint32_t slot);
+    void place(ObjectId id, size_t depth);  // Into the drawing order, renumbering what is above
+    void renumber(size_t first_depth);
+    template <typename T>
+    static void swap_remove(std::vector<T>& items, std::vector<ObjectId>& ids, std::vector<Slot>& slots, uint32_t slot);
 };
 
-class Rectangle{
-    public:
-        std::vector<Rect> rects;
-
-        void add_rect(double x, double y, double width, double height, Color color);
+// One undoable change to the scene, stored as the smallest delta that reverts it.
+// Adds and erases swap objects between the scene and the stash: undoing one
+// extracts `ids` into the stash and restores what was stashed, which leaves
+// the edit ready to redo by doing the same again. Moves and resizes keep only
+// the selection's IDs and the transform.
+struct SceneEdit {
+    enum class Type { ADD, ERASE, MOVE, RESIZE };
+    Type type = Type::ADD;
+    std::vector<ObjectId> ids;  // In the scene: added objects and pieces, or the transformed selection
+    std::vector<SceneObject> stash;  // Out of the scene: what an erase removed, what an undone add took
+    double dx = 0.0, dy = 0.0;  // MOVE
+    double scale_x = 1.0, scale_y = 1.0, origin_x = 0.0, origin_y = 0.0;  // RESIZE
+    std::vector<double> weights;  // RESIZE: per ID, the weight on the other side of the edit
+    
+    size_t bytes() const;
+    // Undo journal records
+    void write(std::ostream& out) const;
+    bool read(std::istream& in);
 };
 
-
+// Eraser radius in canvas units until the settings panel changes it
+constexpr double DEFAULT_ERASER_RADIUS = 10.0;
 
 class Eraser{
     private:
-        double eraser_radius;
+        double eraser_radius = DEFAULT_ERASER_RADIUS;
     public:
-        std::vector<Stroke> stroke_to_erase;
-        std::vector<Rect> rectangle_to_erase;
-        std::vector<Circle_Data> circle_to_erase;
+        void set_radius(double radius) { eraser_radius = radius; }
+        double get_radius() const { return eraser_radius; }
+        // Partial mode splits strokes instead of removing them whole
+        void set_partial(bool enabled) { partial = enabled; }
+        bool is_partial() const { return partial; }
+
+        // Objects hit during the current gesture. They stay in the scene as
+        // tombstones (skipped by the background, dimmed on the overlay) until
+        // the gesture ends and they are removed in one pass.
+        std::vector<ObjectId> erased;
+
+        void stage(ObjectId id);
+        bool is_erased(ObjectId id) const { return id < tombstones.size() && tombstones[id]; }
+        void clear();
+        void begin(ObjectId id_limit) { clear(); first_new_id = id_limit; }
+
+        // IDs from first_new_id on were created by this gesture: the pieces a
+        // partial erase left behind, which the undo step records as added
+        ObjectId first_new_id = 0;
+        std::vector<ObjectId> pieces;
+
+        // Tiles under this gesture's hits, invalidated once per frame
+        BoundingBox pending_invalidation;
+        bool has_pending_invalidation = false;
+        void invalidate_later(const BoundingBox& area);
 
         void eraser_while_erasing();
         void eraser_ended_erasing();
+
+    private:
+        bool partial = false;
+        std::vector<bool> tombstones;  // By ID
 };
 
 class CairoDrawingArea : public Gtk::DrawingArea {
 private:
-    //------ UNIFIED OBJECT SYSTEM ------
-    std::vector<std::shared_ptr<DrawableObject>> drawable_objects;
-    SelectionManager selection_manager;
-    
     //------ VARIABLES FOR TOOLBAR TOOLS ------
-    // Legacy variables (will be phased out)
-    std::vector<Stroke> completed_strokes;
+    // Every completed stroke, rectangle and circle
+    SceneStore scene;
     Stroke current_stroke;
 
-    // Rectangle Related variables
-    std::vector<Rectangle> completed_rectangles;
-    Rectangle current_rectangle;
-    
-    // Circle Related variables
-    std::vector<Circle> completed_circles;
-    Circle current_circle;
-
     // Eraser Related variable
     Eraser current_eraser;
+    Point last_eraser_pos;  // Start of the next swept eraser segment
+    
+    // Undo/redo history, bounded by a byte budget
+    UndoLog<SceneEdit> history;
+    
+    // Running totals of the current drag, recorded as one edit when it ends
+    double moved_dx = 0.0, moved_dy = 0.0;
+    double resized_x = 1.0, resized_y = 1.0;
+    double resize_origin_x = 0.0, resize_origin_y = 0.0;
+    
+    // Resize drag: the selection in drawing order with the transforms and
+    // weights it started from, and its box at the start; it is drawn live
+    // instead of from the tiles
+    std::vector<ObjectId> resizing;
+    std::vector<Affine> resize_start_transforms;
+    std::vector<double> resize_start_weights;
+    // Resized strokes draw a copy with an earlier transform baked in, through
+    // what the drag added since; it is rebaked (and its outline rebuilt) only
+    // once that residual scale drifts by RESIZE_PREVIEW_STEP. Parallel to
+    // resizing; unused for shapes, which bake in O(1).
+    std::vector<Stroke> resize_previews;
+    std::vector<Affine> resize_preview_transforms;
+    BoundingBox resize_start_bounds;
 
     // Tool states
     bool is_drawing;
@@ -228,19 +302,22 @@ private:
     bool is_drawing_circle;
     bool is_erasing;
     bool is_selecting;
+    bool is_lassoing;
     bool is_moving;
     bool is_moving_selection;
     bool is_resizing;
     std::string current_tool;
     
-    // Selection state for legacy objects
-    std::vector<int> selected_stroke_indices;
-    std::vector<int> selected_rectangle_indices;
-    std::vector<int> selected_circle_indices;
+    // Selected objects, by ID
+    SelectionSet selection;
     
     // Selection tool variables
     Point selection_start;
     HandlePosition current_handle;
+    
+    // Lasso tool variables
+    std::vector<Point> lasso_points;  // Freehand loop, closed back to the first point
+    LassoPolicy lasso_policy = LassoPolicy::INTERSECTS;
 
     // Rectangle points
     Point rectangle_start;
@@ -254,6 +331,9 @@ private:
     Color default_rectangle_color = Color(0.0, 0.0, 0.0);
     Color default_circle_color = Color(0.0, 0.0, 0.0);
     
+    // Completed strokes are fitted to this error bound (device pixels)
+    double fit_tolerance_px = DEFAULT_FIT_TOLERANCE;
+    
     // Current pen settings
     double current_pen_width = 5.0;  // Default medium size
     Color current_pen_color = Color(0.0, 0.0, 0.8, 1.0);  // Default blue with full opacity
@@ -261,10 +341,29 @@ private:
     // Frame rate limiting
     std::chrono::steady_clock::time_point last_redraw_time;
     
-    // Dual-layer architecture (like Electron app)
-    Cairo::RefPtr<Cairo::ImageSurface> background_surface;  // Cached completed strokes
-    Cairo::RefPtr<Cairo::Context> background_context;
-    bool background_dirty = true;
+    // Dual-layer architecture (like Electron app): completed objects are cached in tiles
+    TileCache background_tiles;
+    
+    // Retained frame: each draw repaints only the damaged part of it
+    Cairo::RefPtr<Cairo::ImageSurface> frame_surface;
+    Cairo::RefPtr<Cairo::Context> frame_context;
+    Cairo::RefPtr<Cairo::Region> damage;  // Widget area to repaint on the next draw
+    bool full_damage = true;
+    size_t live_stable_points = 0;  // Current stroke points already reported as damage
+    BoundingBox live_tail_bounds;  // Current stroke tail the smoother may still re-emit
+    
+    // Wet ink: finalized segments of the stroke being drawn, kept opaque and
+    // composited with the stroke alpha, so each segment is drawn only once
+    Cairo::RefPtr<Cairo::ImageSurface> wet_surface;
+    Cairo::RefPtr<Cairo::Context> wet_context;
+    size_t wet_points = 0;  // Current stroke points already drawn into the wet layer
+    
+    // Lifted selection: while a selection is dragged it is drawn once (with its
+    // highlights) into its own surface, left out of the background tiles and
+    // composited at the drag offset (moved_dx/dy); the geometry moves on release
+    Cairo::RefPtr<Cairo::ImageSurface> lifted_surface;
+    BoundingBox lifted_bounds;  // Canvas area the surface was rendered from
+    bool is_lifted = false;
 public:
     CairoDrawingArea();
     ~CairoDrawingArea();
@@ -272,31 +371,43 @@ public:
     // Public interface
     void clear_canvas();
     void undo();
+    void redo();
+    void set_undo_budget(size_t bytes);  // Oldest history is dropped past this
+    void set_undo_window(size_t bytes);  // History past this goes to the journal in the user cache directory
     void set_stroke_width(double width);
+    void set_eraser_radius(double radius);
+    void set_eraser_partial(bool enabled);
+    void set_lasso_policy(LassoPolicy policy);
+    void set_fit_tolerance(double device_pixels);  // <= 0 keeps every tessellated point as a straight segment
     
     // Background surface management
     void initialize_background_surface(int width, int height);
     void render_stroke_to_background(const Stroke& stroke);
-    void render_rectangle_to_background(const Rectangle& rectangle);
-    void render_circle_to_background(const Circle& circle);
-    void erase_from_background(double x, double y, double radius);
-    void rebuild_background_surface(); // Rebuild after erasing
+    void render_rectangle_to_background(const Rect& rect);
+    void render_circle_to_background(const Circle_Data& circle);
+    void invalidate_background(const BoundingBox& area);  // Re-render only the tiles it touches
+    void rebuild_background_surface(); // Invalidate every tile
     void set_stroke_color(const Color& color);
     void set_stroke_opacity(double opacity);
     void set_rectangle_color(const Color& color);
     void set_drawing_state(std::string state);
     void set_current_cursor();
     void clear_selection();
+    void select_all();
+    void invert_selection();
     
 protected:
     // GTK callbacks
     void on_draw(const Cairo::RefPtr<Cairo::Context>& cr, int width, int height);
+    void draw_frame(const Cairo::RefPtr<Cairo::Context>& cr);  // Background and live layer, clipped to the damage
 
 
     
 private:
     // Input handling
     void setup_input_handling();
+    InputSample sample_from_event(const Gtk::EventController& controller, double x, double y);
+    std::vector<InputSample> collect_motion_samples(const Gtk::EventController& controller, double x, double y);
     
     // ------ DRAWING FUNCTIONS -----
     //
@@ -306,54 +417,89 @@ private:
     void draw_current_stroke_simple(const Cairo::RefPtr<Cairo::Context>& cr, const Stroke& stroke);
     
     // Rectangle
-    void draw_rectangle(const Cairo::RefPtr<Cairo::Context>& cr, const Rectangle& rectangle);
+    void draw_rectangle(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& rect);
     void draw_rectangle_preview(const Cairo::RefPtr<Cairo::Context>& cr, double start_x, double start_y, double end_x, double end_y);
 
     // Circle
-    void draw_circle(const Cairo::RefPtr<Cairo::Context>& cr, const Circle& circle);
+    void draw_circle(const Cairo::RefPtr<Cairo::Context>& cr, const Circle_Data& circle);
+
+    // Any scene object, by kind
+    void draw_object(const Cairo::RefPtr<Cairo::Context>& cr, ObjectId id);
     void draw_circle_preview(const Cairo::RefPtr<Cairo::Context>& cr, double start_x, double start_y, double r);
 
+    // Background tiles
+    void update_background_tiles();  // Re-render dirty tiles from the objects overlapping them
+    
+    // Wet ink
+    void begin_wet_ink();
+    void update_wet_ink();  // Draw newly finalized segments into the wet layer
+    void draw_wet_ink(const Cairo::RefPtr<Cairo::Context>& cr);  // Wet layer plus the live tail
+    void commit_wet_ink();  // Composite the finished stroke into the background tiles
+    
+    // Damage tracking
+    void damage_area(const BoundingBox& area);  // Repaint area on the next draw
+    void damage_live_stroke();  // New and re-emitted segments of the current stroke
+    BoundingBox preview_bounds() const;  // Rectangle, circle or selection rubber band being dragged
+    void queue_damage();  // Redraw if anything was damaged
+    void queue_full_draw();
+
     // Eraser
     void draw_erasing_preview(const Cairo::RefPtr<Cairo::Context>& cr, const Stroke& stroke);
     void draw_rectangle_erasing_preview(const Cairo::RefPtr<Cairo::Context>& cr, const Rect& rect);
 
     
     // Eraser collision detection
-    bool is_stroke_in_eraser_radius(const Stroke& stroke, double eraser_x, double eraser_y, double radius);
-    bool is_rect_in_eraser_radius(const Rect& rect, double eraser_x, double eraser_y, double radius);
-    bool is_circle_in_eraser_radius(const Circle_Data& circle, double eraser_x, double eraser_y, double radius);
-    void update_eraser_collision(double x, double y);
-    void update_eraser_preview(double x, double y);
+    // The eraser sweeps a capsule from the previous pointer position to the current one
+    bool is_stroke_in_eraser_radius(const Stroke& stroke, const Point& from, const Point& to, double radius);
+    bool is_rect_in_eraser_radius(const Rect& rect, const Point& from, const Point& to, double radius);
+    bool is_circle_in_eraser_radius(const Circle_Data& circle, const Point& from, const Point& to, double radius);
+    void update_eraser_collision(const Point& from, const Point& to);  // Stage hits, nothing moves yet
+    void split_strokes_in_eraser(const Point& from, const Point& to);  // Partial mode: stage hit strokes, add their pieces above them
+    void flush_eraser_invalidation();  // Mark this frame's erased tiles dirty
+    void finish_erasing();  // Remove the staged objects from the scene
+    
+    // Undo
+    void apply_edit(SceneEdit& edit, bool forward);  // Invalidates only what the edit touches
+    void record_transform();  // The drag that just ended, as one move or resize edit
     
     // Selection system methods
-    std::shared_ptr<DrawableObject> find_object_at_point(double x, double y);
+    ObjectId find_object_at_point(double x, double y);  // Topmost, or NO_OBJECT
     HandlePosition find_handle_at_point(double x, double y);
     void update_selection(double x, double y, bool multi_select = false);
     void start_move_operation(double x, double y);
     void start_resize_operation(double x, double y, HandlePosition handle);
     void perform_move(double x, double y);
-    void perform_resize(double x, double y);
-    
-    // Object management
-    void add_drawable_object(std::shared_ptr<DrawableObject> obj);
-    void remove_drawable_object(std::shared_ptr<DrawableObject> obj);
+    void perform_resize(double x, double y);  // Scale for the whole drag so far, set as each object's transform
+    void finish_resize();  // Bake the transforms and record the drag
+    void update_resize_previews();  // Rebakes the previews that drifted too far
+    void draw_resize_previews(const Cairo::RefPtr<Cairo::Context>& cr);
+    BoundingBox selection_bounds() const;
     
-    // Selection functions for legacy objects
+    // Selection functions
     void clear_all_selections();
     void select_objects_in_rectangle(double x1, double y1, double x2, double y2);
-    void move_selected_objects(double dx, double dy);
+    void select_objects_in_lasso();
+    bool is_point_on_selection(double x, double y);  // Grabbing the selection to move it
+    void move_selected_objects(double dx, double dy);  // Lifts the selection on the first call, then only moves the surface
+    void lift_selection();
+    void drop_selection();  // Commit the drag offset to the geometry
+    BoundingBox lifted_area() const;  // Where the lifted surface is composited now
     void draw_selection_rectangle(const Cairo::RefPtr<Cairo::Context>& cr, double x1, double y1, double x2, double y2);
+    void draw_lasso(const Cairo::RefPtr<Cairo::Context>& cr);
     void draw_selection_highlights(const Cairo::RefPtr<Cairo::Context>& cr);
+    void draw_selection_handles(const Cairo::RefPtr<Cairo::Context>& cr);
     bool is_point_in_stroke(const Stroke& stroke, double x, double y, double tolerance = 5.0);
     bool is_point_in_rectangle(const Rect& rect, double x, double y);
     bool is_point_in_circle(const Circle_Data& circle, double x, double y);
+    bool hit_test_object(ObjectId id, double x, double y, double stroke_tolerance);  // Shapes are hit inside their outline
     
     // Smoothing helpers
     std::vector<Point> simplify_stroke(const std::vector<Point>& points, double tolerance = 2.0);
     std::vector<Point> ultra_smooth_stroke(const std::vector<Point>& points);
-    std::vector<Point> interpolate_catmull_rom(const std::vector<Point>& points, int segments_per_curve = 8);
-    Point catmull_rom_point(const Point& p0, const Point& p1, const Point& p2, const Point& p3, double t);
+    std::vector<Point> interpolate_catmull_rom(const std::vector<Point>& points, double tolerance = DEFAULT_FLATNESS_TOLERANCE);
     double point_distance(const Point& p1, const Point& p2);
+    double flatness_tolerance() const;  // Tessellation tolerance in canvas units for the current display scale
+    double fit_tolerance() const;  // Curve fitting tolerance in canvas units for the current display scale
 };
 
 // Tool change handler function
@@ -0,0 +1,97 @@
+#include "eraserSettingsPanel.hpp"
+
+EraserSettingsPanel::EraserSettingsPanel() {
+    set_orientation(Gtk::Orientation::VERTICAL);
+    set_spacing(8);
+    set_margin(12);
+    set_size_request(50, -1);
+    
+    // Same look as the pen panel
+    add_css_class("pen-settings-panel");
+    setup_ui();
+}
+
+void EraserSettingsPanel::setup_ui() {
+    // Radius display with vertical +/- buttons
+    m_radius_spin = Gtk::make_managed<Gtk::SpinButton>();
+    m_radius_spin->set_orientation(Gtk::Orientation::VERTICAL);
+    m_radius_spin->set_range(1.0, 100.0);
+    m_radius_spin->set_value(MEDIUM_RADIUS);
+    m_radius_spin->set_increments(1.0, 5.0);
+    m_radius_spin->set_digits(0);
+    m_radius_spin->set_size_request(40, 60);
+    m_radius_spin->add_css_class("size-display");
+    m_radius_spin->signal_value_changed().connect(
+        sigc::mem_fun(*this, &EraserSettingsPanel::on_radius_changed));
+    append(*m_radius_spin);
+    
+    // Radius preset circles - small, medium, large dots
+    m_small_btn = Gtk::make_managed<Gtk::Button>();
+    m_small_btn->set_size_request(32, 32);
+    m_small_btn->add_css_class("size-circle");
+    m_small_btn->add_css_class("size-small");
+    m_small_btn->signal_clicked().connect(
+        sigc::mem_fun(*this, &EraserSettingsPanel::on_small_radius_clicked));
+    append(*m_small_btn);
+    
+    m_medium_btn = Gtk::make_managed<Gtk::Button>();
+    m_medium_btn->set_size_request(32, 32);
+    m_medium_btn->add_css_class("size-circle");
+    m_medium_btn->add_css_class("size-medium");
+    m_medium_btn->signal_clicked().connect(
+        sigc::mem_fun(*this, &EraserSettingsPanel::on_medium_radius_clicked));
+    append(*m_medium_btn);
+    
+    m_large_btn = Gtk::make_managed<Gtk::Button>();
+    m_large_btn->set_size_request(32, 32);
+    m_large_btn->add_css_class("size-circle");
+    m_large_btn->add_css_class("size-large");
+    m_large_btn->signal_clicked().connect(
+        sigc::mem_fun(*this, &EraserSettingsPanel::on_large_radius_clicked));
+    append(*m_large_btn);
+    
+    // Split mode: erase only the touched part of strokes instead of whole strokes
+    m_split_toggle = Gtk::make_managed<Gtk::ToggleButton>();
+    m_split_toggle->set_icon_name("edit-cut-symbolic");
+    m_split_toggle->set_tooltip_text("Erase only the touched part of strokes");
+    m_split_toggle->set_size_request(32, 32);
+    m_split_toggle->signal_toggled().connect(
+        sigc::mem_fun(*this, &EraserSettingsPanel::on_split_toggled));
+    append(*m_split_toggle);
+}
+
+double EraserSettingsPanel::get_eraser_radius() const {
+    return m_radius_spin->get_value();
+}
+
+bool EraserSettingsPanel::get_split_strokes() const {
+    return m_split_toggle->get_active();
+}
+
+void EraserSettingsPanel::on_radius_changed() {
+    m_signal_radius_changed.emit(get_eraser_radius());
+}
+
+void EraserSettingsPanel::on_small_radius_clicked() {
+    m_radius_spin->set_value(SMALL_RADIUS);
+}
+
+void EraserSettingsPanel::on_medium_radius_clicked() {
+    m_radius_spin->set_value(MEDIUM_RADIUS);
+}
+
+void EraserSettingsPanel::on_large_radius_clicked() {
+    m_radius_spin->set_value(LARGE_RADIUS);
+}
+
+void EraserSettingsPanel::on_split_toggled() {
+    m_signal_split_changed.emit(get_split_strokes());
+}
+
+sigc::signal<void(double)> EraserSettingsPanel::signal_radius_changed() {
+    return m_signal_radius_changed;
+}
+
+sigc::signal<void(bool)> EraserSettingsPanel::signal_split_changed() {
+    return m_signal_split_changed;
+}
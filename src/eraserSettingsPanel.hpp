@@ -0,0 +1,42 @@
+#pragma once
+
+#include <gtkmm.h>
+
+class EraserSettingsPanel : public Gtk::Box{
+    
+    public:
+        EraserSettingsPanel();
+        virtual ~EraserSettingsPanel() = default;
+
+        double get_eraser_radius() const;
+        bool get_split_strokes() const;
+
+        // Signals for when settings change
+        sigc::signal<void(double)> signal_radius_changed();
+        sigc::signal<void(bool)> signal_split_changed();
+
+    private:
+        void setup_ui();
+        void on_radius_changed();
+        void on_small_radius_clicked();
+        void on_medium_radius_clicked();
+        void on_large_radius_clicked();
+        void on_split_toggled();
+
+        // Widgets
+        Gtk::SpinButton* m_radius_spin;
+        Gtk::Button* m_small_btn;
+        Gtk::Button* m_medium_btn;
+        Gtk::Button* m_large_btn;
+        Gtk::ToggleButton* m_split_toggle;
+
+        // Preset radii, medium matches the canvas default
+        static constexpr double SMALL_RADIUS = 5.0;
+        static constexpr double MEDIUM_RADIUS = 10.0;
+        static constexpr double LARGE_RADIUS = 25.0;
+
+        // Signals
+        sigc::signal<void(double)> m_signal_radius_changed;
+        sigc::signal<void(bool)> m_signal_split_changed;
+
+};
@@ -0,0 +1,171 @@
+#include "geometry.hpp"
+#include <algorithm>
+#include <cmath>
+
+Affine Affine::translation(double dx, double dy) {
+    Affine m;
+    m.x0 = dx;
+    m.y0 = dy;
+    return m;
+}
+
+Affine Affine::scaling(double scale_x, double scale_y, double origin_x, double origin_y) {
+    Affine m;
+    m.xx = scale_x;
+    m.yy = scale_y;
+    m.x0 = origin_x - origin_x * scale_x;
+    m.y0 = origin_y - origin_y * scale_y;
+    return m;
+}
+
+Affine Affine::rotation(double radians, double origin_x, double origin_y) {
+    double c = std::cos(radians), s = std::sin(radians);
+    Affine m;
+    m.xx = c;
+    m.yx = s;
+    m.xy = -s;
+    m.yy = c;
+    m.x0 = origin_x - (c * origin_x - s * origin_y);
+    m.y0 = origin_y - (s * origin_x + c * origin_y);
+    return m;
+}
+
+double Affine::mean_scale() const {
+    return std::sqrt(std::abs(xx * yy - xy * yx));
+}
+
+BoundingBox Affine::apply(const BoundingBox& box) const {
+    Point corners[4] = {apply(Point(box.x, box.y)), apply(Point(box.x + box.width, box.y)),
+                        apply(Point(box.x, box.y + box.height)), apply(Point(box.x + box.width, box.y + box.height))};
+    double x1 = corners[0].x, y1 = corners[0].y, x2 = x1, y2 = y1;
+    for (const Point& p : corners) {
+        x1 = std::min(x1, p.x);
+        y1 = std::min(y1, p.y);
+        x2 = std::max(x2, p.x);
+        y2 = std::max(y2, p.y);
+    }
+    return BoundingBox(x1, y1, x2 - x1, y2 - y1);
+}
+
+Affine Affine::then(const Affine& next) const {
+    Affine m;
+    m.xx = next.xx * xx + next.xy * yx;
+    m.yx = next.yx * xx + next.yy * yx;
+    m.xy = next.xx * xy + next.xy * yy;
+    m.yy = next.yx * xy + next.yy * yy;
+    m.x0 = next.xx * x0 + next.xy * y0 + next.x0;
+    m.y0 = next.yx * x0 + next.yy * y0 + next.y0;
+    return m;
+}
+
+Affine Affine::inverse() const {
+    double det = xx * yy - xy * yx;
+    if (std::abs(det) < 1e-12) return Affine();
+    Affine m;
+    m.xx = yy / det;
+    m.yx = -yx / det;
+    m.xy = -xy / det;
+    m.yy = xx / det;
+    m.x0 = -(m.xx * x0 + m.xy * y0);
+    m.y0 = -(m.yx * x0 + m.yy * y0);
+    return m;
+}
+
+double point_segment_distance_squared(const Point& p, const Point& a, const Point& b) {
+    double dx = b.x - a.x;
+    double dy = b.y - a.y;
+    double len2 = dx * dx + dy * dy;
+
+    // Parameter of the closest point, clamped to the segment
+    double t = 0.0;
+    if (len2 > 1e-12) {
+        t = ((p.x - a.x) * dx + (p.y - a.y) * dy) / len2;
+        t = std::min(1.0, std::max(0.0, t));
+    }
+    return distance_squared(p, Point(a.x + t * dx, a.y + t * dy));
+}
+
+double point_box_distance_squared(const Point& p, const BoundingBox& box) {
+    double cx = std::max(box.x, std::min(p.x, box.x + box.width));
+    double cy = std::max(box.y, std::min(p.y, box.y + box.height));
+    return distance_squared(p, Point(cx, cy));
+}
+
+bool segment_intersects_box(const Point& a, const Point& b, const BoundingBox& box) {
+    // Liang-Barsky: clip the parameter range [0, 1] against each slab
+    double t0 = 0.0, t1 = 1.0;
+    double d[2] = {b.x - a.x, b.y - a.y};
+    double lo[2] = {box.x - a.x, box.y - a.y};
+    double hi[2] = {box.x + box.width - a.x, box.y + box.height - a.y};
+    for (int axis = 0; axis < 2; axis++) {
+        if (d[axis] == 0.0) {
+            if (lo[axis] > 0.0 || hi[axis] < 0.0) return false;
+            continue;
+        }
+        double ta = lo[axis] / d[axis], tb = hi[axis] / d[axis];
+        if (ta > tb) std::swap(ta, tb);
+        t0 = std::max(t0, ta);
+        t1 = std::min(t1, tb);
+        if (t0 > t1) return false;
+    }
+    return true;
+}
+
+// Signed area of the triangle a, b, c (twice over); the sign tells the side of c
+static double cross(const Point& a, const Point& b, const Point& c) {
+    return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+double segment_segment_distance_squared(const Point& a, const Point& b, const Point& c, const Point& d) {
+    // Proper crossing: each segment's ends lie on opposite sides of the other
+    double d1 = cross(c, d, a), d2 = cross(c, d, b);
+    double d3 = cross(a, b, c), d4 = cross(a, b, d);
+    if (((d1 > 0 && d2 < 0) || (d1 < 0 && d2 > 0)) && ((d3 > 0 && d4 < 0) || (d3 < 0 && d4 > 0))) return 0.0;
+
+    // Otherwise the closest pair always involves an endpoint
+    return std::min(std::min(point_segment_distance_squared(a, c, d), point_segment_distance_squared(b, c, d)),
+                    std::min(point_segment_distance_squared(c, a, b), point_segment_distance_squared(d, a, b)));
+}
+
+bool segments_intersect(const Point& a, const Point& b, const Point& c, const Point& d) {
+    // Disjoint boxes can't touch
+    if (std::max(a.x, b.x) < std::min(c.x, d.x) || std::max(c.x, d.x) < std::min(a.x, b.x) ||
+        std::max(a.y, b.y) < std::min(c.y, d.y) || std::max(c.y, d.y) < std::min(a.y, b.y)) return false;
+    return segment_segment_distance_squared(a, b, c, d) <= 0.0;
+}
+
+double segment_box_distance_squared(const Point& a, const Point& b, const BoundingBox& box) {
+    if (segment_intersects_box(a, b, box)) return 0.0;
+
+    // Outside and not crossing: the closest pair is a segment end or a box corner
+    Point corners[4] = {Point(box.x, box.y), Point(box.x + box.width, box.y),
+                        Point(box.x, box.y + box.height), Point(box.x + box.width, box.y + box.height)};
+    double best = std::min(point_box_distance_squared(a, box), point_box_distance_squared(b, box));
+    for (const auto& corner : corners) best = std::min(best, point_segment_distance_squared(corner, a, b));
+    return best;
+}
+
+bool polyline_intersects_capsule(const StrokePoints& points, double width, const Point& a, const Point& b, double radius) {
+    if (points.empty()) return false;
+    if (points.size() == 1) {
+        double reach = width * points.width_scale(0) / 2.0 + radius;
+        return point_segment_distance_squared(points[0], a, b) <= reach * reach;
+    }
+
+    double query_x1 = std::min(a.x, b.x), query_x2 = std::max(a.x, b.x);
+    double query_y1 = std::min(a.y, b.y), query_y2 = std::max(a.y, b.y);
+    Point prev = points[0];
+    for (size_t i = 1; i < points.size(); i++) {
+        Point next = points[i];
+        double half_width = width * std::max(points.width_scale(i - 1), points.width_scale(i)) / 2.0;
+        double reach = half_width + radius;
+        // Cheap rejection: the two segment boxes, grown by the reach, must overlap
+        if (query_x2 >= std::min(prev.x, next.x) - reach && query_x1 <= std::max(prev.x, next.x) + reach &&
+            query_y2 >= std::min(prev.y, next.y) - reach && query_y1 <= std::max(prev.y, next.y) + reach &&
+            capsule_intersects_capsule(prev, next, half_width, a, b, radius)) {
+            return true;
+        }
+        prev = next;
+    }
+    return false;
+}
@@ -0,0 +1,100 @@
+#pragma once
+
+#include "strokePoints.hpp"
+
+// Bounding box for selection and collision detection
+struct BoundingBox {
+    double x, y, width, height;
+    
+    BoundingBox(double x = 0, double y = 0, double w = 0, double h = 0) 
+        : x(x), y(y), width(w), height(h) {}
+    
+    bool contains_point(double px, double py) const {
+        return px >= x && px <= x + width && py >= y && py <= y + height;
+    }
+    
+    bool intersects(const BoundingBox& other) const {
+        return x <= other.x + other.width && other.x <= x + width &&
+               y <= other.y + other.height && other.y <= y + height;
+    }
+};
+
+// 2x3 affine map in Cairo's layout: x' = xx * x + xy * y + x0, y' = yx * x + yy * y + y0
+struct Affine {
+    double xx = 1.0, yx = 0.0, xy = 0.0, yy = 1.0, x0 = 0.0, y0 = 0.0;
+    
+    static Affine translation(double dx, double dy);
+    static Affine scaling(double scale_x, double scale_y, double origin_x, double origin_y);  // About the origin point
+    static Affine rotation(double radians, double origin_x, double origin_y);
+    
+    bool is_identity() const { return xx == 1.0 && yx == 0.0 && xy == 0.0 && yy == 1.0 && x0 == 0.0 && y0 == 0.0; }
+    bool is_axis_aligned() const { return yx == 0.0 && xy == 0.0; }  // Scale and translation only
+    double mean_scale() const;  // Square root of the area ratio, for tolerances
+    
+    Point apply(const Point& p) const { return Point(xx * p.x + xy * p.y + x0, yx * p.x + yy * p.y + y0); }
+    BoundingBox apply(const BoundingBox& box) const;  // Box around the mapped corners
+    Affine then(const Affine& next) const;  // This map followed by next
+    Affine inverse() const;  // Identity if the map is singular
+};
+
+// Hit tests compare squared distances so the common miss never takes a sqrt
+
+inline double distance_squared(const Point& a, const Point& b) {
+    double dx = b.x - a.x;
+    double dy = b.y - a.y;
+    return dx * dx + dy * dy;
+}
+
+// Squared distance from p to the closest point of segment a -> b
+double point_segment_distance_squared(const Point& p, const Point& a, const Point& b);
+
+// Squared distance from p to the closest point of the box (0 inside it)
+double point_box_distance_squared(const Point& p, const BoundingBox& box);
+
+// Whether the box comes within `radius` of center; the early-out before any finer test
+inline bool box_intersects_circle(const BoundingBox& box, const Point& center, double radius) {
+    return point_box_distance_squared(center, box) <= radius * radius;
+}
+
+// Whether the capsule swept by a disc of `capsule_radius` along a -> b overlaps the circle
+inline bool capsule_intersects_circle(const Point& a, const Point& b, double capsule_radius,
+                                      const Point& center, double radius) {
+    double reach = capsule_radius + radius;
+    return point_segment_distance_squared(center, a, b) <= reach * reach;
+}
+
+// Whether segment a -> b touches the box (either end inside, or crossing it)
+bool segment_intersects_box(const Point& a, const Point& b, const BoundingBox& box);
+
+// Squared distance between the closest points of segments a -> b and c -> d (0 if they cross)
+double segment_segment_distance_squared(const Point& a, const Point& b, const Point& c, const Point& d);
+
+// Whether segments a -> b and c -> d cross or touch
+bool segments_intersect(const Point& a, const Point& b, const Point& c, const Point& d);
+
+// Squared distance from segment a -> b to the box (0 if it touches it)
+double segment_box_distance_squared(const Point& a, const Point& b, const BoundingBox& box);
+
+// Whether two capsules (discs of radius ra / rc swept along a -> b / c -> d) overlap
+inline bool capsule_intersects_capsule(const Point& a, const Point& b, double ra,
+                                       const Point& c, const Point& d, double rc) {
+    double reach = ra + rc;
+    return segment_segment_distance_squared(a, b, c, d) <= reach * reach;
+}
+
+// Box around segment a -> b grown by radius on every side
+inline BoundingBox capsule_bounds(const Point& a, const Point& b, double radius) {
+    double x1 = a.x < b.x ? a.x : b.x, y1 = a.y < b.y ? a.y : b.y;
+    double x2 = a.x < b.x ? b.x : a.x, y2 = a.y < b.y ? b.y : a.y;
+    return BoundingBox(x1 - radius, y1 - radius, x2 - x1 + 2 * radius, y2 - y1 + 2 * radius);
+}
+
+// Whether a polyline comes within `radius` of segment a -> b (a point when
+// a == b). Each polyline segment is a capsule of width * (wider end's width
+// scale) / 2, so width 0 tests the bare centerline. Segments whose box
+// misses the query capsule's box are skipped cheaply.
+bool polyline_intersects_capsule(const StrokePoints& points, double width, const Point& a, const Point& b, double radius);
+
+inline bool polyline_intersects_circle(const StrokePoints& points, double width, const Point& center, double radius) {
+    return polyline_intersects_capsule(points, width, center, center, radius);
+}
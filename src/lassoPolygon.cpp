@@ -0,0 +1,79 @@
+#include "lassoPolygon.hpp"
+#include <algorithm>
+#include <cmath>
+
+// Upper bound on the number of bands; about one per vertex below it
+static const size_t MAX_LASSO_BANDS = 256;
+
+LassoPolygon::LassoPolygon(const std::vector<Point>& points) : vertices(points) {
+    if (empty()) return;
+
+    double min_x = vertices[0].x, max_x = vertices[0].x;
+    double min_y = vertices[0].y, max_y = vertices[0].y;
+    for (const auto& p : vertices) {
+        min_x = std::min(min_x, p.x);
+        max_x = std::max(max_x, p.x);
+        min_y = std::min(min_y, p.y);
+        max_y = std::max(max_y, p.y);
+    }
+    bounds = BoundingBox(min_x, min_y, max_x - min_x, max_y - min_y);
+
+    size_t band_count = std::max<size_t>(1, std::min(vertices.size(), MAX_LASSO_BANDS));
+    band_height = std::max(bounds.height / band_count, 1e-9);
+    bands.resize(band_count);
+    for (uint32_t edge = 0; edge < vertices.size(); edge++) {
+        Point a = vertices[edge], b = edge_end(edge);
+        int first = band_of(std::min(a.y, b.y)), last = band_of(std::max(a.y, b.y));
+        for (int band = first; band <= last; band++) bands[band].push_back(edge);
+    }
+}
+
+int LassoPolygon::band_of(double y) const {
+    int band = (int)std::floor((y - bounds.y) / band_height);
+    return std::max(0, std::min((int)bands.size() - 1, band));
+}
+
+bool LassoPolygon::contains(const Point& p) const {
+    if (empty() || !bounds.contains_point(p.x, p.y)) return false;
+
+    // Count the edges a ray to the right crosses; every edge spanning p.y is in p's band
+    bool inside = false;
+    for (uint32_t edge : bands[band_of(p.y)]) {
+        Point a = vertices[edge], b = edge_end(edge);
+        if ((a.y > p.y) != (b.y > p.y)) {
+            double x = a.x + (p.y - a.y) * (b.x - a.x) / (b.y - a.y);
+            if (p.x < x) inside = !inside;
+        }
+    }
+    return inside;
+}
+
+bool LassoPolygon::crosses_segment(const Point& a, const Point& b) const {
+    if (empty()) return false;
+    BoundingBox segment_box(std::min(a.x, b.x), std::min(a.y, b.y), std::abs(b.x - a.x), std::abs(b.y - a.y));
+    if (!bounds.intersects(segment_box)) return false;
+
+    // An edge spanning several bands is tested once per band; harmless for a yes/no answer
+    int first = band_of(segment_box.y), last = band_of(segment_box.y + segment_box.height);
+    for (int band = first; band <= last; band++) {
+        for (uint32_t edge : bands[band]) {
+            if (segments_intersect(a, b, vertices[edge], edge_end(edge))) return true;
+        }
+    }
+    return false;
+}
+
+LassoCoverage LassoPolygon::classify_box(const BoundingBox& box) const {
+    if (empty() || !bounds.intersects(box)) return LassoCoverage::OUTSIDE;
+
+    int first = band_of(box.y), last = band_of(box.y + box.height);
+    for (int band = first; band <= last; band++) {
+        for (uint32_t edge : bands[band]) {
+            if (segment_intersects_box(vertices[edge], edge_end(edge), box)) return LassoCoverage::PARTIAL;
+        }
+    }
+
+    // No edge reaches the box, so all of it is on one side of the boundary
+    Point center(box.x + box.width / 2.0, box.y + box.height / 2.0);
+    return contains(center) ? LassoCoverage::INSIDE : LassoCoverage::OUTSIDE;
+}
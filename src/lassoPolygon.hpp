@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "geometry.hpp"
+
+// How much of a box a lasso covers
+enum class LassoCoverage {
+    OUTSIDE,
+    PARTIAL,  // An edge of the lasso passes through the box
+    INSIDE
+};
+
+// Which objects a lasso selects
+enum class LassoPolicy {
+    INTERSECTS,  // Any part inside or crossing the loop
+    CONTAINED    // Wholly inside it
+};
+
+// Closed polygon (the last vertex joins the first) with its edges bucketed
+// into horizontal bands, so a containment or crossing test only looks at the
+// edges in the bands it spans instead of every edge. Containment uses the
+// even-odd rule, which is what a self-crossing freehand loop looks like.
+class LassoPolygon {
+public:
+    explicit LassoPolygon(const std::vector<Point>& vertices);
+
+    bool empty() const { return vertices.size() < 3; }
+    const BoundingBox& get_bounds() const { return bounds; }
+
+    bool contains(const Point& p) const;
+    bool crosses_segment(const Point& a, const Point& b) const;  // Touches any edge
+
+    // Coarse test for a whole object box; only PARTIAL needs a finer look
+    LassoCoverage classify_box(const BoundingBox& box) const;
+
+private:
+    std::vector<Point> vertices;
+    BoundingBox bounds;
+    double band_height = 1.0;
+    std::vector<std::vector<uint32_t>> bands;  // Edge i runs from vertex i to vertex i + 1
+
+    int band_of(double y) const;
+    Point edge_end(uint32_t edge) const { return vertices[(edge + 1) % vertices.size()]; }
+};
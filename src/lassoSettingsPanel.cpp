@@ -0,0 +1,39 @@
+#include "lassoSettingsPanel.hpp"
+
+LassoSettingsPanel::LassoSettingsPanel() {
+    set_orientation(Gtk::Orientation::VERTICAL);
+    set_spacing(8);
+    set_margin(12);
+    set_size_request(50, -1);
+    
+    // Same look as the pen panel
+    add_css_class("pen-settings-panel");
+    setup_ui();
+}
+
+void LassoSettingsPanel::setup_ui() {
+    // Two grouped toggles: exactly one policy is active
+    m_touch_btn = Gtk::make_managed<Gtk::ToggleButton>("Touch");
+    m_touch_btn->set_tooltip_text("Select objects the lasso touches");
+    m_touch_btn->set_active(true);
+    append(*m_touch_btn);
+    
+    m_inside_btn = Gtk::make_managed<Gtk::ToggleButton>("Inside");
+    m_inside_btn->set_tooltip_text("Select only objects fully inside the lasso");
+    m_inside_btn->set_group(*m_touch_btn);
+    m_inside_btn->signal_toggled().connect(
+        sigc::mem_fun(*this, &LassoSettingsPanel::on_policy_toggled));
+    append(*m_inside_btn);
+}
+
+bool LassoSettingsPanel::get_contained_only() const {
+    return m_inside_btn->get_active();
+}
+
+void LassoSettingsPanel::on_policy_toggled() {
+    m_signal_policy_changed.emit(get_contained_only());
+}
+
+sigc::signal<void(bool)> LassoSettingsPanel::signal_policy_changed() {
+    return m_signal_policy_changed;
+}
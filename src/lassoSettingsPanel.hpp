@@ -0,0 +1,28 @@
+#pragma once
+
+#include <gtkmm.h>
+
+class LassoSettingsPanel : public Gtk::Box{
+    
+    public:
+        LassoSettingsPanel();
+        virtual ~LassoSettingsPanel() = default;
+
+        // True when only objects fully inside the lasso get selected
+        bool get_contained_only() const;
+
+        // Signal for when the policy changes
+        sigc::signal<void(bool)> signal_policy_changed();
+
+    private:
+        void setup_ui();
+        void on_policy_toggled();
+
+        // Widgets
+        Gtk::ToggleButton* m_touch_btn;
+        Gtk::ToggleButton* m_inside_btn;
+
+        // Signals
+        sigc::signal<void(bool)> m_signal_policy_changed;
+
+};
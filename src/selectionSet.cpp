@@ -0,0 +1,49 @@
+#include "selectionSet.hpp"
+
+bool SelectionSet::add(uint32_t id) {
+    if (contains(id)) return false;
+    if (id / 64 >= bits.size()) bits.resize(id / 64 + 1, 0);
+    if (id >= positions.size()) positions.resize(id + 1, 0);
+
+    bits[id / 64] |= uint64_t(1) << (id % 64);
+    positions[id] = (uint32_t)members.size();
+    members.push_back(id);
+    return true;
+}
+
+bool SelectionSet::remove(uint32_t id) {
+    if (!contains(id)) return false;
+    bits[id / 64] &= ~(uint64_t(1) << (id % 64));
+
+    // The last member fills the hole
+    uint32_t position = positions[id];
+    uint32_t last = members.back();
+    members[position] = last;
+    positions[last] = position;
+    members.pop_back();
+    return true;
+}
+
+void SelectionSet::toggle(uint32_t id) {
+    if (!remove(id)) add(id);
+}
+
+void SelectionSet::clear() {
+    for (uint32_t id : members) bits[id / 64] &= ~(uint64_t(1) << (id % 64));
+    members.clear();
+}
+
+void SelectionSet::select_all(const std::vector<uint32_t>& universe) {
+    for (uint32_t id : universe) add(id);
+}
+
+void SelectionSet::invert(const std::vector<uint32_t>& universe) {
+    // Collect the complement against the old bits, then swap it in
+    std::vector<uint32_t> inverted;
+    inverted.reserve(universe.size() >= members.size() ? universe.size() - members.size() : 0);
+    for (uint32_t id : universe) {
+        if (!contains(id)) inverted.push_back(id);
+    }
+    clear();
+    for (uint32_t id : inverted) add(id);
+}
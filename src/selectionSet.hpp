@@ -0,0 +1,40 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Set of selected object IDs: one bit per ID answers membership in O(1),
+// and a compact list of the members (with each member's position in it)
+// keeps iteration proportional to the selection and removal O(1).
+class SelectionSet {
+public:
+    bool contains(uint32_t id) const { return id / 64 < bits.size() && (bits[id / 64] >> (id % 64)) & 1; }
+    bool add(uint32_t id);  // False if it was already selected
+    bool remove(uint32_t id);  // False if it wasn't selected
+    void toggle(uint32_t id);
+    void clear();  // O(selected), not O(IDs)
+
+    // Every ID in `universe` / exactly the IDs in `universe` that weren't selected
+    void select_all(const std::vector<uint32_t>& universe);
+    void invert(const std::vector<uint32_t>& universe);
+
+    // Drops the members `gone` says no longer exist
+    template <typename Predicate>
+    void remove_if(Predicate gone) {
+        for (size_t i = members.size(); i-- > 0;) {
+            if (gone(members[i])) remove(members[i]);
+        }
+    }
+
+    const std::vector<uint32_t>& ids() const { return members; }
+    std::vector<uint32_t>::const_iterator begin() const { return members.begin(); }
+    std::vector<uint32_t>::const_iterator end() const { return members.end(); }
+    bool empty() const { return members.empty(); }
+    size_t size() const { return members.size(); }
+
+private:
+    std::vector<uint64_t> bits;  // By ID
+    std::vector<uint32_t> members;  // Unordered
+    std::vector<uint32_t> positions;  // By ID: index in members, valid while the bit is set
+};
@@ -0,0 +1,102 @@
+#include "spatialGrid.hpp"
+#include <algorithm>
+#include <cmath>
+
+uint64_t SpatialGrid::cell_key(int column, int row) {
+    return ((uint64_t)(uint32_t)column << 32) | (uint32_t)row;
+}
+
+void SpatialGrid::cell_span(const BoundingBox& box, int& first_column, int& first_row, int& last_column, int& last_row) const {
+    first_column = (int)std::floor(box.x / cell_size);
+    first_row = (int)std::floor(box.y / cell_size);
+    last_column = (int)std::floor((box.x + box.width) / cell_size);
+    last_row = (int)std::floor((box.y + box.height) / cell_size);
+}
+
+void SpatialGrid::insert(uint32_t key, const BoundingBox& bounds) {
+    if (contains(key)) unlink(key);
+    if (key >= item_bounds.size()) {
+        item_bounds.resize(key + 1);
+        present.resize(key + 1, false);
+    }
+    item_bounds[key] = bounds;
+    present[key] = true;
+
+    int first_column, first_row, last_column, last_row;
+    cell_span(bounds, first_column, first_row, last_column, last_row);
+    for (int row = first_row; row <= last_row; row++) {
+        for (int column = first_column; column <= last_column; column++) {
+            cells[cell_key(column, row)].push_back(key);
+        }
+    }
+}
+
+void SpatialGrid::update(uint32_t key, const BoundingBox& bounds) {
+    insert(key, bounds);
+}
+
+void SpatialGrid::unlink(uint32_t key) {
+    int first_column, first_row, last_column, last_row;
+    cell_span(item_bounds[key], first_column, first_row, last_column, last_row);
+    for (int row = first_row; row <= last_row; row++) {
+        for (int column = first_column; column <= last_column; column++) {
+            auto cell = cells.find(cell_key(column, row));
+            if (cell == cells.end()) continue;
+            auto& keys = cell->second;
+            keys.erase(std::remove(keys.begin(), keys.end(), key), keys.end());
+            if (keys.empty()) cells.erase(cell);
+        }
+    }
+    present[key] = false;
+}
+
+void SpatialGrid::remove(uint32_t key) {
+    if (contains(key)) unlink(key);
+}
+
+void SpatialGrid::clear() {
+    cells.clear();
+    item_bounds.clear();
+    present.clear();
+}
+
+std::vector<uint32_t> SpatialGrid::query_rect(const BoundingBox& area) const {
+    std::vector<uint32_t> result;
+    if (cells.empty()) return result;
+
+    if (query_stamp.size() < present.size()) query_stamp.resize(present.size(), 0);
+    if (++query_counter == 0) {
+        std::fill(query_stamp.begin(), query_stamp.end(), 0);
+        query_counter = 1;
+    }
+
+    auto visit = [&](const std::vector<uint32_t>& keys) {
+        for (uint32_t key : keys) {
+            if (query_stamp[key] == query_counter) continue;
+            query_stamp[key] = query_counter;
+            if (item_bounds[key].intersects(area)) result.push_back(key);
+        }
+    };
+
+    int first_column, first_row, last_column, last_row;
+    cell_span(area, first_column, first_row, last_column, last_row);
+    double span = (double)(last_column - first_column + 1) * (last_row - first_row + 1);
+    if (span > cells.size()) {
+        // Area covers more cells than exist: walking the occupied ones is cheaper
+        for (const auto& cell : cells) visit(cell.second);
+    } else {
+        for (int row = first_row; row <= last_row; row++) {
+            for (int column = first_column; column <= last_column; column++) {
+                auto cell = cells.find(cell_key(column, row));
+                if (cell != cells.end()) visit(cell->second);
+            }
+        }
+    }
+
+    std::sort(result.begin(), result.end());
+    return result;
+}
+
+std::vector<uint32_t> SpatialGrid::query_radius(double x, double y, double radius) const {
+    return query_rect(BoundingBox(x - radius, y - radius, 2 * radius, 2 * radius));
+}
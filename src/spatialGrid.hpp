@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include <unordered_map>
+#include "geometry.hpp"
+
+// Edge length of one index cell, in canvas units
+constexpr double SPATIAL_CELL_SIZE = 128.0;
+
+// Uniform grid over object bounding boxes. Keys are small integers (the
+// scene's object IDs); every cell an object's box touches
+// lists its key. Queries return candidates whose box intersects the query
+// area, in ascending key order, for the caller to hit test exactly.
+class SpatialGrid {
+public:
+    explicit SpatialGrid(double cell_size = SPATIAL_CELL_SIZE) : cell_size(cell_size) {}
+
+    void insert(uint32_t key, const BoundingBox& bounds);
+    void update(uint32_t key, const BoundingBox& bounds);  // After a move or scale
+    void remove(uint32_t key);
+    void clear();
+
+    std::vector<uint32_t> query_rect(const BoundingBox& area) const;
+    std::vector<uint32_t> query_radius(double x, double y, double radius) const;
+
+    bool contains(uint32_t key) const { return key < present.size() && present[key]; }
+    const BoundingBox& get_bounds(uint32_t key) const { return item_bounds[key]; }
+
+private:
+    double cell_size;
+    std::unordered_map<uint64_t, std::vector<uint32_t>> cells;
+    std::vector<BoundingBox> item_bounds;  // By key
+    std::vector<bool> present;
+
+    // Per-key stamp of the last query that reported it, to drop duplicates across cells
+    mutable std::vector<uint32_t> query_stamp;
+    mutable uint32_t query_counter = 0;
+
+    static uint64_t cell_key(int column, int row);
+    void cell_span(const BoundingBox& box, int& first_column, int& first_row, int& last_column, int& last_row) const;
+    void unlink(uint32_t key);  // Drops the key from the cells of its current box
+};
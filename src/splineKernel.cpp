@@ -0,0 +1,164 @@
+#include "splineKernel.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define SPLINE_KERNEL_X86 1
+#endif
+
+// Largest step count with a precomputed basis; bigger segments fall back to on-the-fly t
+static const int BASIS_MAX_STEPS = 64;
+
+// Basis values (t, t^2, t^3) for t = j / steps, j = 1..steps, one row per step count
+struct SplineBasis {
+    std::vector<double> t, t2, t3;
+    size_t offset[BASIS_MAX_STEPS + 1];
+
+    SplineBasis() {
+        size_t total = 0;
+        for (int steps = 1; steps <= BASIS_MAX_STEPS; steps++) {
+            offset[steps] = total;
+            total += steps;
+        }
+        t.assign(total, 0.0);
+        t2.assign(total, 0.0);
+        t3.assign(total, 0.0);
+        for (int steps = 1; steps <= BASIS_MAX_STEPS; steps++) {
+            for (int j = 1; j <= steps; j++) {
+                size_t k = offset[steps] + j - 1;
+                t[k] = (double)j / steps;
+                t2[k] = t[k] * t[k];
+                t3[k] = t2[k] * t[k];
+            }
+        }
+    }
+};
+
+static const SplineBasis& spline_basis() {
+    static const SplineBasis basis;
+    return basis;
+}
+
+SplineSegment make_catmull_rom_segment(const Point& p0, const Point& p1, const Point& p2, const Point& p3, int steps) {
+    // Catmull-Rom spline formula with the 0.5 factor folded in (exact in binary floating point)
+    SplineSegment s;
+    s.cx[0] = 0.5 * (2.0 * p1.x);
+    s.cx[1] = 0.5 * (-p0.x + p2.x);
+    s.cx[2] = 0.5 * (2.0 * p0.x - 5.0 * p1.x + 4.0 * p2.x - p3.x);
+    s.cx[3] = 0.5 * (-p0.x + 3.0 * p1.x - 3.0 * p2.x + p3.x);
+    s.cy[0] = 0.5 * (2.0 * p1.y);
+    s.cy[1] = 0.5 * (-p0.y + p2.y);
+    s.cy[2] = 0.5 * (2.0 * p0.y - 5.0 * p1.y + 4.0 * p2.y - p3.y);
+    s.cy[3] = 0.5 * (-p0.y + 3.0 * p1.y - 3.0 * p2.y + p3.y);
+    s.steps = steps;
+    return s;
+}
+
+// Scalar evaluation of steps [first, steps) of one segment
+static void evaluate_tail(const SplineSegment& s, int first, double* xs, double* ys) {
+    for (int j = first; j < s.steps; j++) {
+        double t = (double)(j + 1) / s.steps;
+        double t2 = t * t;
+        double t3 = t2 * t;
+        xs[j] = s.cx[0] + s.cx[1] * t + s.cx[2] * t2 + s.cx[3] * t3;
+        ys[j] = s.cy[0] + s.cy[1] * t + s.cy[2] * t2 + s.cy[3] * t3;
+    }
+}
+
+static void evaluate_scalar(const SplineSegment* segments, size_t count, double* xs, double* ys) {
+    for (size_t i = 0; i < count; i++) {
+        evaluate_tail(segments[i], 0, xs, ys);
+        xs += segments[i].steps;
+        ys += segments[i].steps;
+    }
+}
+
+#ifdef SPLINE_KERNEL_X86
+static void evaluate_sse2(const SplineSegment* segments, size_t count, double* xs, double* ys) {
+    const SplineBasis& basis = spline_basis();
+    for (size_t i = 0; i < count; i++) {
+        const SplineSegment& s = segments[i];
+        int j = 0;
+        if (s.steps <= BASIS_MAX_STEPS) {
+            const double* bt = &basis.t[basis.offset[s.steps]];
+            const double* bt2 = &basis.t2[basis.offset[s.steps]];
+            const double* bt3 = &basis.t3[basis.offset[s.steps]];
+            __m128d ax = _mm_set1_pd(s.cx[0]), bx = _mm_set1_pd(s.cx[1]), cx = _mm_set1_pd(s.cx[2]), dx = _mm_set1_pd(s.cx[3]);
+            __m128d ay = _mm_set1_pd(s.cy[0]), by = _mm_set1_pd(s.cy[1]), cy = _mm_set1_pd(s.cy[2]), dy = _mm_set1_pd(s.cy[3]);
+            for (; j + 2 <= s.steps; j += 2) {
+                __m128d t = _mm_loadu_pd(bt + j), t2 = _mm_loadu_pd(bt2 + j), t3 = _mm_loadu_pd(bt3 + j);
+                __m128d x = _mm_add_pd(_mm_add_pd(_mm_add_pd(ax, _mm_mul_pd(bx, t)), _mm_mul_pd(cx, t2)), _mm_mul_pd(dx, t3));
+                __m128d y = _mm_add_pd(_mm_add_pd(_mm_add_pd(ay, _mm_mul_pd(by, t)), _mm_mul_pd(cy, t2)), _mm_mul_pd(dy, t3));
+                _mm_storeu_pd(xs + j, x);
+                _mm_storeu_pd(ys + j, y);
+            }
+        }
+        evaluate_tail(s, j, xs, ys);
+        xs += s.steps;
+        ys += s.steps;
+    }
+}
+
+__attribute__((target("avx2")))
+static void evaluate_avx2(const SplineSegment* segments, size_t count, double* xs, double* ys) {
+    const SplineBasis& basis = spline_basis();
+    for (size_t i = 0; i < count; i++) {
+        const SplineSegment& s = segments[i];
+        int j = 0;
+        if (s.steps <= BASIS_MAX_STEPS) {
+            const double* bt = &basis.t[basis.offset[s.steps]];
+            const double* bt2 = &basis.t2[basis.offset[s.steps]];
+            const double* bt3 = &basis.t3[basis.offset[s.steps]];
+            __m256d ax = _mm256_set1_pd(s.cx[0]), bx = _mm256_set1_pd(s.cx[1]), cx = _mm256_set1_pd(s.cx[2]), dx = _mm256_set1_pd(s.cx[3]);
+            __m256d ay = _mm256_set1_pd(s.cy[0]), by = _mm256_set1_pd(s.cy[1]), cy = _mm256_set1_pd(s.cy[2]), dy = _mm256_set1_pd(s.cy[3]);
+            // Separate multiply and add (no FMA) keeps results identical to the other paths
+            for (; j + 4 <= s.steps; j += 4) {
+                __m256d t = _mm256_loadu_pd(bt + j), t2 = _mm256_loadu_pd(bt2 + j), t3 = _mm256_loadu_pd(bt3 + j);
+                __m256d x = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(ax, _mm256_mul_pd(bx, t)), _mm256_mul_pd(cx, t2)), _mm256_mul_pd(dx, t3));
+                __m256d y = _mm256_add_pd(_mm256_add_pd(_mm256_add_pd(ay, _mm256_mul_pd(by, t)), _mm256_mul_pd(cy, t2)), _mm256_mul_pd(dy, t3));
+                _mm256_storeu_pd(xs + j, x);
+                _mm256_storeu_pd(ys + j, y);
+            }
+            // Leave the upper halves clean before running legacy SSE code
+            _mm256_zeroupper();
+        }
+        evaluate_tail(s, j, xs, ys);
+        xs += s.steps;
+        ys += s.steps;
+    }
+}
+#endif
+
+using SplineKernel = void (*)(const SplineSegment*, size_t, double*, double*);
+
+struct KernelChoice {
+    SplineKernel kernel;
+    const char* name;
+};
+
+static KernelChoice select_kernel() {
+#ifdef SPLINE_KERNEL_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return {evaluate_avx2, "avx2"};
+    if (__builtin_cpu_supports("sse2")) return {evaluate_sse2, "sse2"};
+#endif
+    return {evaluate_scalar, "scalar"};
+}
+
+static const KernelChoice& kernel_choice() {
+    static const KernelChoice choice = select_kernel();
+    return choice;
+}
+
+size_t evaluate_spline_segments(const std::vector<SplineSegment>& segments,
+                                std::vector<double>& xs, std::vector<double>& ys) {
+    size_t total = 0;
+    for (const auto& s : segments) total += s.steps;
+    xs.resize(total);
+    ys.resize(total);
+    if (total > 0) kernel_choice().kernel(segments.data(), segments.size(), xs.data(), ys.data());
+    return total;
+}
+
+const char* spline_kernel_name() {
+    return kernel_choice().name;
+}
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "strokePoints.hpp"
+
+// One Catmull-Rom segment expanded to its cubic polynomial
+// x(t) = cx[0] + cx[1] t + cx[2] t^2 + cx[3] t^3 (same for y), to be
+// evaluated at t = j / steps for j = 1..steps.
+struct SplineSegment {
+    double cx[4], cy[4];
+    int steps;
+};
+
+SplineSegment make_catmull_rom_segment(const Point& p0, const Point& p1, const Point& p2, const Point& p3, int steps);
+
+// Evaluates every step of every segment in one pass and writes them in
+// order to xs / ys (resized to the total step count). Uses AVX2 when the
+// CPU supports it, SSE2 otherwise; all paths produce identical results.
+size_t evaluate_spline_segments(const std::vector<SplineSegment>& segments,
+                                std::vector<double>& xs, std::vector<double>& ys);
+
+// Name of the kernel selected at runtime ("avx2", "sse2" or "scalar")
+const char* spline_kernel_name();
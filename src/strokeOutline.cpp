@@ -0,0 +1,11 @@
+#include "strokeOutline.hpp"
+#include <algorithm>
+#include <cmath>
+
+double pen_width_scale(const InputSample& sample) {
+    double pressure = std::min(std::max(sample.pressure, 0.0), 1.0);
+    double tilt = std::min(1.0, sqrt(sample.tilt_x * sample.tilt_x + sample.tilt_y * sample.tilt_y));
+
+    // 0.3x at the lightest touch, 1.7x at full pressure; up to +50% when tilted flat
+    return (0.3 + 1.4 * pressure) * (1.0 + 0.5 * tilt);
+}
@@ -0,0 +1,7 @@
+#pragma once
+
+#include "strokePoints.hpp"
+
+// Width multiplier for one input sample: pressure scales around the nominal
+// width (0.5 -> 1.0x) and a tilted pen draws a broader line.
+double pen_width_scale(const InputSample& sample);
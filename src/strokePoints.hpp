@@ -0,0 +1,117 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include <cstdint>
+#include "binaryStream.hpp"
+
+// Plain 2D coordinate used for geometry and temporaries
+struct Point {
+    double x, y;
+
+    Point(double x, double y) : x(x), y(y) {}
+};
+
+// Raw pointer sample with the device timestamp (milliseconds, wraps at 2^32).
+// Pressure is 0..1 with 0.5 as the nominal width (devices without a pressure
+// axis report 0.5); tilt is -1..1 on each axis.
+struct InputSample {
+    double x, y;
+    uint32_t time;
+    double pressure = 0.5;
+    double tilt_x = 0.0, tilt_y = 0.0;
+};
+
+// Compact polyline storage for strokes: struct-of-arrays float coordinates
+// relative to a per-stroke origin plus a quantized width scale (9 bytes per
+// point). Points are read back by value, so translating the whole stroke
+// only moves the origin.
+class StrokePoints {
+public:
+    class const_iterator {
+    public:
+        const_iterator(const StrokePoints* owner, size_t index) : owner(owner), index(index) {}
+
+        Point operator*() const { return (*owner)[index]; }
+        const_iterator& operator++() { ++index; return *this; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+
+    private:
+        const StrokePoints* owner;
+        size_t index;
+    };
+
+    size_t size() const { return xs.size(); }
+    bool empty() const { return xs.empty(); }
+
+    Point operator[](size_t i) const { return Point(origin_x + xs[i], origin_y + ys[i]); }
+    Point front() const { return (*this)[0]; }
+    Point back() const { return (*this)[xs.size() - 1]; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, xs.size()); }
+
+    // Pen width multiplier at point i (pressure and tilt), 0..2.55
+    double width_scale(size_t i) const { return widths[i] / WIDTH_SCALE_STEPS; }
+
+    void push_back(const Point& p, double width_scale = 1.0) { emplace_back(p.x, p.y, width_scale); }
+    void emplace_back(double x, double y, double width_scale = 1.0) {
+        // First point of the stroke becomes the origin
+        if (xs.empty()) {
+            origin_x = x;
+            origin_y = y;
+        }
+        xs.push_back((float)(x - origin_x));
+        ys.push_back((float)(y - origin_y));
+
+        double quantized = width_scale * WIDTH_SCALE_STEPS + 0.5;
+        widths.push_back((uint8_t)(quantized < 0.0 ? 0.0 : (quantized > 255.0 ? 255.0 : quantized)));
+    }
+
+    void clear() { xs.clear(); ys.clear(); widths.clear(); }
+    void truncate(size_t count) {
+        if (count < xs.size()) {
+            xs.resize(count);
+            ys.resize(count);
+            widths.resize(count);
+        }
+    }
+    void reserve(size_t count) { xs.reserve(count); ys.reserve(count); widths.reserve(count); }
+    void shrink_to_fit() { xs.shrink_to_fit(); ys.shrink_to_fit(); widths.shrink_to_fit(); }
+
+    // Transformations
+    void translate(double dx, double dy) { origin_x += dx; origin_y += dy; }
+    void scale(double scale_x, double scale_y, double center_x, double center_y) {
+        origin_x = center_x + (origin_x - center_x) * scale_x;
+        origin_y = center_y + (origin_y - center_y) * scale_y;
+        for (size_t i = 0; i < xs.size(); i++) {
+            xs[i] = (float)(xs[i] * scale_x);
+            ys[i] = (float)(ys[i] * scale_y);
+        }
+    }
+
+    size_t memory_bytes() const {
+        return (xs.capacity() + ys.capacity()) * sizeof(float) + widths.capacity();
+    }
+
+    void write(std::ostream& out) const {
+        write_value(out, origin_x);
+        write_value(out, origin_y);
+        write_vector(out, xs);
+        write_vector(out, ys);
+        write_vector(out, widths);
+    }
+    bool read(std::istream& in) {
+        return read_value(in, origin_x) && read_value(in, origin_y) &&
+               read_vector(in, xs) && read_vector(in, ys) && read_vector(in, widths) &&
+               ys.size() == xs.size() && widths.size() == xs.size();
+    }
+
+private:
+    static constexpr double WIDTH_SCALE_STEPS = 100.0;  // 255 steps reach pen_width_scale's 2.55x maximum
+
+    double origin_x = 0.0, origin_y = 0.0;
+    std::vector<float> xs, ys;
+    std::vector<uint8_t> widths;
+};
@@ -0,0 +1,136 @@
+#include "strokeSmoother.hpp"
+#include "bezierFit.hpp"
+#include <cmath>
+#include <algorithm>
+
+int catmull_rom_subdivisions(const Point& p0, const Point& p1, const Point& p2, const Point& p3,
+                             double tolerance, int max_segments) {
+    if (tolerance <= 0.0) return max_segments;
+
+    // Bezier control points of the same segment
+    double b1x = p1.x + (p2.x - p0.x) / 6.0;
+    double b1y = p1.y + (p2.y - p0.y) / 6.0;
+    double b2x = p2.x - (p3.x - p1.x) / 6.0;
+    double b2y = p2.y - (p3.y - p1.y) / 6.0;
+
+    return bezier_subdivisions(p1, Point(b1x, b1y), Point(b2x, b2y), p2, tolerance, max_segments);
+}
+
+// StrokeSmoother implementation
+void StrokeSmoother::reset() {
+    window.clear();
+    window_widths.clear();
+    batch_xs = std::vector<double>();
+    batch_ys = std::vector<double>();
+    has_pending = false;
+    kept_count = 0;
+    finalized_segments = 0;
+    finalized_points = 0;
+}
+
+const Point& StrokeSmoother::control_point(size_t index) const {
+    if (index == kept_count) return pending;
+    return window[index - (kept_count - window.size())];
+}
+
+double StrokeSmoother::control_width(size_t index) const {
+    if (index == kept_count) return pending_width;
+    return window_widths[index - (kept_count - window_widths.size())];
+}
+
+void StrokeSmoother::queue_segment(size_t index, size_t total) {
+    // Get the four control points for Catmull-Rom spline
+    const Point& p0 = (index > 0) ? control_point(index - 1) : control_point(index);
+    const Point& p1 = control_point(index);
+    const Point& p2 = control_point(index + 1);
+    const Point& p3 = (index + 2 < total) ? control_point(index + 2) : control_point(index + 1);
+
+    // Straight or very short segments need only a few steps
+    int steps = catmull_rom_subdivisions(p0, p1, p2, p3, tolerance, max_segments_per_curve);
+    batch.push_back(make_catmull_rom_segment(p0, p1, p2, p3, steps));
+    batch_widths.push_back(control_width(index));
+    batch_widths.push_back(control_width(index + 1));
+}
+
+void StrokeSmoother::flush_segments(StrokePoints& out) {
+    // Evaluate all queued segments in one vectorized pass
+    evaluate_spline_segments(batch, batch_xs, batch_ys);
+
+    size_t k = 0;
+    for (size_t i = 0; i < batch.size(); i++) {
+        int steps = batch[i].steps;
+        double w1 = batch_widths[2 * i];
+        double w2 = batch_widths[2 * i + 1];
+        for (int j = 1; j <= steps; j++, k++) {
+            out.emplace_back(batch_xs[k], batch_ys[k], w1 + (w2 - w1) * j / steps);
+        }
+    }
+    batch.clear();
+    batch_widths.clear();
+}
+
+void StrokeSmoother::add_sample(const Point& sample, StrokePoints& out, double width_scale) {
+    // First sample is always kept as the start of the stroke
+    if (kept_count == 0) {
+        window.push_back(sample);
+        window_widths.push_back(width_scale);
+        kept_count = 1;
+        out.clear();
+        out.push_back(sample, width_scale);
+        return;
+    }
+
+    // The previous newest sample is now an interior point: light simplification
+    // to remove micro-jitter, keep it only if it's far enough from the last kept point
+    if (has_pending) {
+        const Point& prev = window.back();
+        double dx = pending.x - prev.x;
+        double dy = pending.y - prev.y;
+        if (sqrt(dx * dx + dy * dy) >= jitter_threshold) {
+            window.push_back(pending);
+            window_widths.push_back(pending_width);
+            if (window.size() > 4) {
+                window.erase(window.begin());
+                window_widths.erase(window_widths.begin());
+            }
+            kept_count++;
+        }
+    }
+    pending = sample;
+    pending_width = width_scale;
+    has_pending = true;
+
+    // Newest sample is always the last control point
+    size_t total = kept_count + 1;
+    if (total == 2) {
+        out.clear();
+        out.push_back(control_point(0), control_width(0));
+        out.push_back(pending, pending_width);
+        return;
+    }
+
+    // Drop the tail emitted for the previous sample
+    if (finalized_points == 0) {
+        out.clear();
+        out.push_back(control_point(0), control_width(0));
+        finalized_points = 1;
+    } else {
+        out.truncate(finalized_points);
+    }
+
+    // A segment is final once all four of its control points are confirmed
+    size_t newly_finalized_steps = 0;
+    while (finalized_segments + 3 <= kept_count) {
+        queue_segment(finalized_segments, total);
+        newly_finalized_steps += batch.back().steps;
+        finalized_segments++;
+    }
+
+    // Re-emit the tail segments that still depend on the newest sample
+    for (size_t i = finalized_segments; i + 1 < total; i++) {
+        queue_segment(i, total);
+    }
+
+    finalized_points += newly_finalized_steps;
+    flush_segments(out);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <vector>
+#include <cstddef>
+#include "strokePoints.hpp"
+#include "splineKernel.hpp"
+
+// Flatness tolerance for spline tessellation, in device pixels
+constexpr double DEFAULT_FLATNESS_TOLERANCE = 0.25;
+constexpr int MAX_SEGMENTS_PER_CURVE = 32;
+
+// Number of uniform steps needed to keep the polyline of one Catmull-Rom
+// segment (p1 -> p2) within `tolerance` of the curve. A tolerance <= 0
+// disables the adaptive estimate and always returns `max_segments`.
+int catmull_rom_subdivisions(const Point& p0, const Point& p1, const Point& p2, const Point& p3,
+                             double tolerance, int max_segments = MAX_SEGMENTS_PER_CURVE);
+
+// Streaming Catmull-Rom smoother used while a stroke is being drawn.
+// Only the last few control points are kept; each new sample finalizes at
+// most one spline segment and re-emits the short tail that still depends on
+// the newest (not yet confirmed) sample, so the cost per sample is constant.
+class StrokeSmoother {
+public:
+    StrokeSmoother(double tolerance = DEFAULT_FLATNESS_TOLERANCE, int max_segments_per_curve = MAX_SEGMENTS_PER_CURVE,
+                   double jitter_threshold = 0.5)
+        : tolerance(tolerance), max_segments_per_curve(max_segments_per_curve), jitter_threshold(jitter_threshold) {}
+
+    // Feed one raw sample and update the smooth points in `out` in place.
+    // `width_scale` is interpolated linearly along the segments it touches.
+    void add_sample(const Point& sample, StrokePoints& out, double width_scale = 1.0);
+    void reset();
+
+    // Tolerance in canvas units; applies to segments emitted from now on
+    void set_tolerance(double t) { tolerance = t; }
+    double get_tolerance() const { return tolerance; }
+    // Leading points of `out` that later samples will no longer change
+    size_t get_finalized_points() const { return finalized_points; }
+
+private:
+    double tolerance;
+    int max_segments_per_curve;
+    double jitter_threshold;
+
+    std::vector<Point> window;      // Last (up to 4) control points that survived the jitter filter
+    std::vector<double> window_widths;
+    Point pending = Point(0.0, 0.0); // Newest sample, not yet known to survive the filter
+    double pending_width = 1.0;
+    bool has_pending = false;
+    size_t kept_count = 0;          // Total number of control points that survived the filter
+    size_t finalized_segments = 0;  // Segments whose four control points are all confirmed
+    size_t finalized_points = 0;    // Number of points in `out` that will never change again
+
+    // Segments queued for one batched kernel call, with their end widths
+    std::vector<SplineSegment> batch;
+    std::vector<double> batch_widths;
+    std::vector<double> batch_xs, batch_ys;
+
+    const Point& control_point(size_t index) const;
+    double control_width(size_t index) const;
+    void queue_segment(size_t index, size_t total);
+    void flush_segments(StrokePoints& out);
+};
@@ -0,0 +1,123 @@
+#include "tileCache.hpp"
+#include <cmath>
+#include <algorithm>
+
+// Antialiased edges spill up to a pixel past an object's geometric bounds
+static const double TILE_MARGIN = 1.0;
+
+bool BackgroundTile::overlaps(double area_x, double area_y, double area_width, double area_height) const {
+    return area_x - TILE_MARGIN < x + BACKGROUND_TILE_SIZE && area_x + area_width + TILE_MARGIN > x &&
+           area_y - TILE_MARGIN < y + BACKGROUND_TILE_SIZE && area_y + area_height + TILE_MARGIN > y;
+}
+
+void TileCache::resize(int new_width, int new_height) {
+    int new_columns = (std::max(new_width, 0) + BACKGROUND_TILE_SIZE - 1) / BACKGROUND_TILE_SIZE;
+    int new_rows = (std::max(new_height, 0) + BACKGROUND_TILE_SIZE - 1) / BACKGROUND_TILE_SIZE;
+
+    // Tiles never move, so growing or shrinking the widget only adds or drops edge tiles
+    std::vector<BackgroundTile> new_tiles(new_columns * new_rows);
+    for (int row = 0; row < new_rows; row++) {
+        for (int column = 0; column < new_columns; column++) {
+            BackgroundTile& tile = new_tiles[row * new_columns + column];
+            if (row < rows && column < columns) {
+                tile = std::move(tiles[row * columns + column]);
+            } else {
+                tile.x = column * BACKGROUND_TILE_SIZE;
+                tile.y = row * BACKGROUND_TILE_SIZE;
+            }
+        }
+    }
+
+    tiles = std::move(new_tiles);
+    width = new_width;
+    height = new_height;
+    columns = new_columns;
+    rows = new_rows;
+}
+
+bool TileCache::tile_span(double x, double y, double area_width, double area_height,
+                          int& first_column, int& first_row, int& last_column, int& last_row) const {
+    if (tiles.empty()) return false;
+
+    first_column = std::max(0, (int)std::floor((x - TILE_MARGIN) / BACKGROUND_TILE_SIZE));
+    first_row = std::max(0, (int)std::floor((y - TILE_MARGIN) / BACKGROUND_TILE_SIZE));
+    last_column = std::min(columns - 1, (int)std::floor((x + area_width + TILE_MARGIN) / BACKGROUND_TILE_SIZE));
+    last_row = std::min(rows - 1, (int)std::floor((y + area_height + TILE_MARGIN) / BACKGROUND_TILE_SIZE));
+    return first_column <= last_column && first_row <= last_row;
+}
+
+void TileCache::invalidate(double x, double y, double area_width, double area_height) {
+    int first_column, first_row, last_column, last_row;
+    if (!tile_span(x, y, area_width, area_height, first_column, first_row, last_column, last_row)) return;
+
+    for (int row = first_row; row <= last_row; row++) {
+        for (int column = first_column; column <= last_column; column++) {
+            tiles[row * columns + column].dirty = true;
+        }
+    }
+}
+
+void TileCache::set_scale(int new_scale) {
+    if (new_scale == scale) return;
+    scale = new_scale;
+    for (auto& tile : tiles) {
+        tile.surface.reset();
+        tile.context.reset();
+        tile.dirty = true;
+    }
+}
+
+void TileCache::invalidate_all() {
+    for (auto& tile : tiles) tile.dirty = true;
+}
+
+std::vector<BackgroundTile*> TileCache::dirty_tiles() {
+    std::vector<BackgroundTile*> result;
+    for (auto& tile : tiles) {
+        if (tile.dirty) result.push_back(&tile);
+    }
+    return result;
+}
+
+std::vector<BackgroundTile*> TileCache::clean_tiles_in(double x, double y, double area_width, double area_height) {
+    std::vector<BackgroundTile*> result;
+    int first_column, first_row, last_column, last_row;
+    if (!tile_span(x, y, area_width, area_height, first_column, first_row, last_column, last_row)) return result;
+
+    for (int row = first_row; row <= last_row; row++) {
+        for (int column = first_column; column <= last_column; column++) {
+            BackgroundTile& tile = tiles[row * columns + column];
+            if (!tile.dirty) result.push_back(&tile);
+        }
+    }
+    return result;
+}
+
+void TileCache::begin_tile(BackgroundTile& tile) {
+    if (!tile.surface) {
+        // Backed by device pixels so HiDPI output stays sharp; drawn in widget units
+        tile.surface = Cairo::ImageSurface::create(Cairo::Surface::Format::ARGB32,
+                                                   BACKGROUND_TILE_SIZE * scale, BACKGROUND_TILE_SIZE * scale);
+        tile.surface->set_device_scale(scale, scale);
+        tile.context = Cairo::Context::create(tile.surface);
+        tile.context->translate(-tile.x, -tile.y);
+    }
+
+    tile.context->save();
+    tile.context->set_operator(Cairo::Context::Operator::CLEAR);
+    tile.context->paint();
+    tile.context->restore();
+    tile.dirty = false;
+}
+
+void TileCache::paint(const Cairo::RefPtr<Cairo::Context>& cr) const {
+    double clip_x1, clip_y1, clip_x2, clip_y2;
+    cr->get_clip_extents(clip_x1, clip_y1, clip_x2, clip_y2);
+
+    for (const auto& tile : tiles) {
+        if (!tile.surface || !tile.overlaps(clip_x1, clip_y1, clip_x2 - clip_x1, clip_y2 - clip_y1)) continue;
+        cr->set_source(tile.surface, tile.x, tile.y);
+        cr->rectangle(tile.x, tile.y, BACKGROUND_TILE_SIZE, BACKGROUND_TILE_SIZE);
+        cr->fill();
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cairomm/cairomm.h>
+#include <vector>
+
+// Edge length of one background tile, in widget pixels
+constexpr int BACKGROUND_TILE_SIZE = 256;
+
+struct BackgroundTile {
+    int x = 0, y = 0;  // Top-left corner in widget coordinates
+    Cairo::RefPtr<Cairo::ImageSurface> surface;  // Allocated on first render
+    Cairo::RefPtr<Cairo::Context> context;  // Translated so canvas coordinates draw in place
+    bool dirty = true;  // Needs a clear and a re-render of the objects overlapping it
+
+    // Whether an area (plus an antialiasing margin) reaches into this tile
+    bool overlaps(double area_x, double area_y, double area_width, double area_height) const;
+};
+
+// Completed-object cache split into a fixed grid of tiles anchored at the
+// widget origin. Mutations mark only the tiles their bounds touch as dirty;
+// the owner re-renders those before painting.
+class TileCache {
+public:
+    // Keeps the tiles that are still inside the widget, new ones start dirty
+    void resize(int width, int height);
+    int get_width() const { return width; }
+    int get_height() const { return height; }
+    // Device pixels per widget pixel; a change drops every tile surface
+    void set_scale(int new_scale);
+    int get_scale() const { return scale; }
+
+    void invalidate(double x, double y, double area_width, double area_height);
+    void invalidate_all();
+
+    std::vector<BackgroundTile*> dirty_tiles();
+    std::vector<BackgroundTile*> clean_tiles_in(double x, double y, double area_width, double area_height);
+
+    // Allocates the tile surface if needed, clears it and marks it clean
+    void begin_tile(BackgroundTile& tile);
+
+    // Blits every rendered tile that intersects the clip of `cr`
+    void paint(const Cairo::RefPtr<Cairo::Context>& cr) const;
+
+private:
+    int width = 0, height = 0;
+    int scale = 1;
+    int columns = 0, rows = 0;
+    std::vector<BackgroundTile> tiles;  // Row-major
+
+    // Inclusive column/row span touched by an area; false if it misses the grid
+    bool tile_span(double x, double y, double area_width, double area_height,
+                   int& first_column, int& first_row, int& last_column, int& last_row) const;
+};
@@ -106,6 +106,7 @@ window {
 
 /* Tool-specific colors */
 .select-tool.selected { background: #10b981; border-color: #059669; }
+.lasso-tool.selected { background: #14b8a6; border-color: #0d9488; }
 .rectangle-tool.selected { background: #f59e0b; border-color: #d97706; }
 .circle-tool.selected { background: #ef4444; border-color: #dc2626; }
 .arrow-tool.selected { background: #8b5cf6; border-color: #7c3aed; }
@@ -388,7 +389,9 @@ UI_ToolBar::UI_ToolBar()
       selected_button(nullptr),
       current_tool_name("select"),
       settingPanel(nullptr),
-      m_pen_settings_panel(nullptr)
+      m_pen_settings_panel(nullptr),
+      m_eraser_settings_panel(nullptr),
+      m_lasso_settings_panel(nullptr)
 {
     
     // Initialize tools
@@ -401,7 +404,8 @@ UI_ToolBar::UI_ToolBar()
         {"pen", "../assets/pen.svg", "Draw", "pen-tool"},
         {"text", "../assets/text.svg", "Text", "text-tool"},
         {"eraser", "../assets/eraser.svg", "Eraser", "eraser-tool"},
-        {"setting", "../assets/setting.svg", "Setting", "setting"}
+        {"setting", "../assets/setting.svg", "Setting", "setting"},
+        {"lasso", "../assets/lasso.svg", "Lasso selection", "lasso-tool"}
     };
     base_css_provider = Gtk::CssProvider::create();
     scale_css_provider = Gtk::CssProvider::create();
@@ -417,6 +421,8 @@ UI_ToolBar::UI_ToolBar()
     
     // Setup pen settings panel as overlay
     m_pen_settings_panel = Gtk::make_managed<PenSettingsPanel>();
+    m_eraser_settings_panel = Gtk::make_managed<EraserSettingsPanel>();
+    m_lasso_settings_panel = Gtk::make_managed<LassoSettingsPanel>();
     
     // Setup layout with overlay
     set_child(main_box);
@@ -426,6 +432,8 @@ UI_ToolBar::UI_ToolBar()
     // Add canvas as base layer and pen settings as overlay
     canvas_overlay.set_child(canvas.get_widget());
     canvas_overlay.add_overlay(*m_pen_settings_panel);
+    canvas_overlay.add_overlay(*m_eraser_settings_panel);
+    canvas_overlay.add_overlay(*m_lasso_settings_panel);
     
     // Position the pen settings panel on the left side, vertically centered
     m_pen_settings_panel->set_halign(Gtk::Align::START);
@@ -433,8 +441,20 @@ UI_ToolBar::UI_ToolBar()
     m_pen_settings_panel->set_margin_start(20);
     m_pen_settings_panel->set_margin_top(20);
     
+    // Eraser settings take the same spot, only one tool is active at a time
+    m_eraser_settings_panel->set_halign(Gtk::Align::START);
+    m_eraser_settings_panel->set_valign(Gtk::Align::START);
+    m_eraser_settings_panel->set_margin_start(20);
+    m_eraser_settings_panel->set_margin_top(20);
+    m_lasso_settings_panel->set_halign(Gtk::Align::START);
+    m_lasso_settings_panel->set_valign(Gtk::Align::START);
+    m_lasso_settings_panel->set_margin_start(20);
+    m_lasso_settings_panel->set_margin_top(20);
+    
     // Hide by default since select is default tool  
     m_pen_settings_panel->set_visible(false);
+    m_eraser_settings_panel->set_visible(false);
+    m_lasso_settings_panel->set_visible(false);
 
     settingButton->signal_clicked().connect(
         sigc::mem_fun(*this, &UI_ToolBar::on_setting_clicked)
@@ -463,6 +483,22 @@ void UI_ToolBar::setup_pen_settings_connections() {
             canvas.get_drawing_area().set_stroke_opacity(opacity);
         });
     }
+    
+    if (m_eraser_settings_panel) {
+        m_eraser_settings_panel->signal_radius_changed().connect([this](double radius) {
+            canvas.get_drawing_area().set_eraser_radius(radius);
+        });
+        
+        m_eraser_settings_panel->signal_split_changed().connect([this](bool split) {
+            canvas.get_drawing_area().set_eraser_partial(split);
+        });
+    }
+    
+    if (m_lasso_settings_panel) {
+        m_lasso_settings_panel->signal_policy_changed().connect([this](bool contained_only) {
+            canvas.get_drawing_area().set_lasso_policy(contained_only ? LassoPolicy::CONTAINED : LassoPolicy::INTERSECTS);
+        });
+    }
 }
 
 void UI_ToolBar::setup_css() {
@@ -520,8 +556,9 @@ void UI_ToolBar::create_toolbar() {
     toolbar_wrapper.add_css_class("toolbar-wrapper");
     toolbar_container.add_css_class("toolbar-container");
     
-    // Add selection tool
+    // Add selection tools
     toolbar_container.append(*create_tool_button(tools[0]));
+    toolbar_container.append(*create_tool_button(tools[9])); // lasso
     toolbar_container.append(*create_separator());
     
     // Add shape tools
@@ -609,6 +646,12 @@ void UI_ToolBar::on_tool_selected(Gtk::Button* button, const std::string& tool_n
             m_pen_settings_panel->set_visible(false);
         }
     }
+    if (m_eraser_settings_panel) {
+        m_eraser_settings_panel->set_visible(tool_name == "eraser");
+    }
+    if (m_lasso_settings_panel) {
+        m_lasso_settings_panel->set_visible(tool_name == "lasso");
+    }
     
     // Call the callback if set
     if (tool_change_callback) {
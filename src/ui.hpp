@@ -5,6 +5,8 @@
 #include "canvas.hpp"
 #include "settingPanel.hpp"
 #include "penSettingsPanel.hpp"
+#include "eraserSettingsPanel.hpp"
+#include "lassoSettingsPanel.hpp"
 
 
 struct ToolInfo{
@@ -28,6 +30,12 @@ class UI_ToolBar : public Gtk::ApplicationWindow{
          
          // Pen settings panel (overlay)
          PenSettingsPanel* m_pen_settings_panel;
+         
+         // Eraser settings panel (overlay)
+         EraserSettingsPanel* m_eraser_settings_panel;
+         
+         // Lasso settings panel (overlay)
+         LassoSettingsPanel* m_lasso_settings_panel;
 
     protected:
          void on_setting_clicked();
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdio>
+#include <deque>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <algorithm>
+
+// Stack of edits kept in a file instead of memory. Edits need
+// write(std::ostream&) const and read(std::istream&) returning false on a
+// short or corrupt record. Records sit back to back: push() appends after the
+// newest, pop() reads the newest back and lets the next push overwrite it,
+// and drop_oldest() forgets the bottom one. Once the dropped prefix outgrows
+// the live records, they are copied to a fresh file. Only the record offsets
+// stay in memory; the file is truncated whenever the stack runs empty and
+// removed when the journal is closed.
+template <typename Edit>
+class UndoJournal {
+public:
+    UndoJournal() = default;
+    UndoJournal(const UndoJournal&) = delete;
+    UndoJournal& operator=(const UndoJournal&) = delete;
+    ~UndoJournal() { close(); }
+
+    bool open(const std::string& file_path) {
+        close();
+        path = file_path;
+        file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+        return file.is_open();
+    }
+
+    void close() {
+        if (!file.is_open()) return;
+        file.close();
+        std::remove(path.c_str());
+        records.clear();
+        stored_bytes = 0;
+        file_end = 0;
+        file_size = 0;
+    }
+
+    bool is_open() const { return file.is_open(); }
+    bool empty() const { return records.empty(); }
+    size_t size() const { return records.size(); }
+    size_t memory_bytes() const { return stored_bytes; }  // What the stored edits took in memory
+
+    // False if the write failed; the records already stored stay readable
+    // (the partial one is past the newest and gets overwritten) and the edit
+    // is still the caller's
+    bool push(const Edit& edit, size_t bytes) {
+        if (!file.is_open()) return false;
+        file.clear();
+        file.seekp(file_end);
+        edit.write(file);
+        file.flush();
+        if (!file) {
+            file.clear();
+            std::error_code error;
+            std::uintmax_t size = std::filesystem::file_size(path, error);
+            if (!error) file_size = std::max(file_size, (std::streamoff)size);
+            return false;
+        }
+        records.push_back(Record{file_end, bytes});
+        stored_bytes += bytes;
+        file_end = file.tellp();
+        file_size = std::max(file_size, file_end);
+        return true;
+    }
+
+    // False if there was nothing to read or the record couldn't be read back;
+    // a bad record takes everything below it with it
+    bool pop(Edit& edit) {
+        if (records.empty()) return false;
+        Record record = records.back();
+        records.pop_back();
+        stored_bytes -= record.bytes;
+
+        file.clear();
+        file.seekg(record.offset);
+        bool ok = edit.read(file);
+        file_end = record.offset;  // The record is dead now
+        if (!ok || records.empty()) reset();
+        else if (file_size > 2 * file_end) shrink();
+        return ok;
+    }
+
+    void drop_oldest() {
+        if (records.empty()) return;
+        stored_bytes -= records.front().bytes;
+        records.pop_front();
+        if (records.empty()) reset();
+        else if (records.front().offset > file_end - records.front().offset) compact();
+    }
+
+    // Forget everything and give the disk space back
+    void reset() {
+        records.clear();
+        stored_bytes = 0;
+        file_end = 0;
+        file_size = 0;
+        if (!file.is_open()) return;
+        file.close();
+        file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    }
+
+private:
+    static constexpr size_t COPY_CHUNK = 64 * 1024;
+
+    // Moves the live records to the start of a fresh file; on failure the
+    // journal is emptied rather than left half copied
+    void compact() {
+        std::string compact_path = path + ".compact";
+        std::streamoff shift = records.front().offset;
+        {
+            std::ofstream out(compact_path, std::ios::binary | std::ios::trunc);
+            std::vector<char> buffer(COPY_CHUNK);
+            file.clear();
+            file.seekg(shift);
+            for (std::streamoff left = file_end - shift; left > 0 && out;) {
+                std::streamsize chunk = (std::streamsize)std::min<std::streamoff>(left, (std::streamoff)buffer.size());
+                if (!file.read(buffer.data(), chunk)) break;
+                out.write(buffer.data(), chunk);
+                left -= chunk;
+            }
+            out.flush();
+            if (!file || !out) {
+                out.close();
+                std::remove(compact_path.c_str());
+                reset();
+                return;
+            }
+        }
+
+        file.close();
+        if (std::rename(compact_path.c_str(), path.c_str()) != 0) {
+            std::remove(compact_path.c_str());
+            file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+            reset();
+            return;
+        }
+        file.open(path, std::ios::in | std::ios::out | std::ios::binary);
+        for (auto& record : records) record.offset -= shift;
+        file_end -= shift;
+        file_size = file_end;
+        if (!file.is_open()) reset();
+    }
+
+    // Gives back the dead tail left by pops
+    void shrink() {
+        std::error_code error;
+        file.flush();
+        std::filesystem::resize_file(path, (std::uintmax_t)file_end, error);
+        if (!error) file_size = file_end;
+    }
+
+    struct Record {
+        std::streamoff offset;
+        size_t bytes;
+    };
+
+    std::string path;
+    std::fstream file;
+    std::deque<Record> records;  // Oldest first
+    size_t stored_bytes = 0;
+    std::streamoff file_end = 0;  // End of the newest record
+    std::streamoff file_size = 0;  // Bytes on disk, dead tail included
+};
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <cstddef>
+#include <deque>
+#include <string>
+#include <utility>
+#include "undoJournal.hpp"
+
+// Undo history cap until set_undo_budget() changes it
+constexpr size_t DEFAULT_UNDO_BUDGET = 64 * 1024 * 1024;
+// Part of it kept in memory once a journal is open, until set_undo_window() changes it
+constexpr size_t DEFAULT_UNDO_WINDOW = 8 * 1024 * 1024;
+
+// Undo/redo history of edits that each report their own size with bytes().
+// The caller applies edits: undo() and redo() hand the edit to a callback
+// that reverts or reapplies it in place (and may rewrite it for the way
+// back), then move it to the other side. Recording a new edit drops the
+// redo side; past the byte budget the oldest edits are forgotten.
+//
+// With a journal open, only the window nearest the present stays in memory:
+// steps further back (or further ahead) go to one journal file per side and
+// are paged back in one at a time as undo or redo reaches them.
+template <typename Edit>
+class UndoLog {
+public:
+    void record(Edit edit) {
+        for (const auto& old : undone) held_bytes -= old.bytes();
+        undone.clear();
+        undone_journal.reset();
+        held_bytes += edit.bytes();
+        done.push_back(std::move(edit));
+        trim();
+    }
+
+    template <typename Revert>
+    bool undo(Revert&& revert) { return step(done, done_journal, undone, revert); }
+    template <typename Reapply>
+    bool redo(Reapply&& reapply) { return step(undone, undone_journal, done, reapply); }
+
+    bool can_undo() const { return !done.empty() || !done_journal.empty(); }
+    bool can_redo() const { return !undone.empty() || !undone_journal.empty(); }
+
+    void set_budget(size_t bytes) { budget = bytes; trim(); }
+    size_t get_budget() const { return budget; }
+    void set_window(size_t bytes) { window = bytes; trim(); }
+    size_t get_window() const { return window; }
+    size_t memory_bytes() const { return held_bytes; }
+    size_t journal_bytes() const { return done_journal.memory_bytes() + undone_journal.memory_bytes(); }
+
+    // Journal files are `path_prefix` + ".undo" / ".redo" in an existing
+    // directory; false (history stays in memory) if they can't be created
+    bool open_journal(const std::string& path_prefix) {
+        if (done_journal.open(path_prefix + ".undo") && undone_journal.open(path_prefix + ".redo")) {
+            trim();
+            return true;
+        }
+        close_journal();
+        return false;
+    }
+
+    // Steps on disk are forgotten
+    void close_journal() {
+        done_journal.close();
+        undone_journal.close();
+    }
+
+    void clear() {
+        done.clear();
+        undone.clear();
+        done_journal.reset();
+        undone_journal.reset();
+        held_bytes = 0;
+    }
+
+private:
+    std::deque<Edit> done;  // Oldest first
+    std::deque<Edit> undone;  // Most recently undone at the back, where redo takes from
+    UndoJournal<Edit> done_journal;  // Older than everything in done
+    UndoJournal<Edit> undone_journal;  // Further ahead than everything in undone
+    size_t held_bytes = 0;  // In done and undone
+    size_t budget = DEFAULT_UNDO_BUDGET;
+    size_t window = DEFAULT_UNDO_WINDOW;
+
+    template <typename Apply>
+    bool step(std::deque<Edit>& from, UndoJournal<Edit>& from_journal, std::deque<Edit>& to, Apply& apply) {
+        if (from.empty() && !page_in(from, from_journal)) return false;
+        Edit edit = std::move(from.back());
+        from.pop_back();
+        held_bytes -= edit.bytes();
+
+        apply(edit);
+        held_bytes += edit.bytes();
+        to.push_back(std::move(edit));
+        trim();
+        return true;
+    }
+
+    bool page_in(std::deque<Edit>& into, UndoJournal<Edit>& journal) {
+        Edit edit;
+        if (!journal.pop(edit)) return false;
+        held_bytes += edit.bytes();
+        into.push_front(std::move(edit));
+        return true;
+    }
+
+    // Moves the oldest in-memory step of a side onto its journal; false, with
+    // the step still in memory, if the journal can't take it
+    bool spill(std::deque<Edit>& from, UndoJournal<Edit>& journal) {
+        size_t bytes = from.front().bytes();
+        if (!journal.push(from.front(), bytes)) return false;
+        held_bytes -= bytes;
+        from.pop_front();
+        return true;
+    }
+
+    void trim() {
+        // Forget the oldest undo steps first, then the redo steps furthest away
+        while (held_bytes + journal_bytes() > budget) {
+            if (!done_journal.empty()) done_journal.drop_oldest();
+            else if (!done.empty()) {
+                held_bytes -= done.front().bytes();
+                done.pop_front();
+            } else if (!undone_journal.empty()) undone_journal.drop_oldest();
+            else if (!undone.empty()) {
+                held_bytes -= undone.front().bytes();
+                undone.pop_front();
+            } else break;
+        }
+
+        // Past the window, the steps furthest from the present go to disk; if
+        // a write fails they stay in memory (still under the budget) and the
+        // next trim tries again
+        if (!done_journal.is_open()) return;
+        while (held_bytes > window && !done.empty()) {
+            if (!spill(done, done_journal)) return;
+        }
+        while (held_bytes > window && !undone.empty()) {
+            if (!spill(undone, undone_journal)) return;
+        }
+    }
+};